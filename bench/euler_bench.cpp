@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#endif
+#include "number_theory.h"
+#include "rng.h"
+#include "sieve.h"
+
+// Microbenchmarks for the number_theory kernels over fixed input sets.
+// Each kernel gets one warm-up pass and `reps` timed passes over its
+// inputs; every pass is cut into blocks of roughly a microsecond, and the
+// median and p99 are taken over all block timings in ns per op.
+//   usage: euler_bench [--reps N] [--seed S] [--filter TEXT] [--json FILE]
+
+namespace {
+
+volatile uint64_t g_sink;
+
+uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+struct BenchOptions {
+    size_t reps = 5;
+    uint64_t seed = 42;
+    std::string filter;
+    std::string json_path;
+};
+
+struct BenchResult {
+    std::string name, input;
+    size_t ops = 0;
+    double median_ns = 0, p99_ns = 0, mean_ns = 0;
+    // TSC ticks per op at the median block; the TSC runs at a fixed
+    // reference rate, not the current core clock.
+    double cycles_per_op = 0;
+};
+
+double percentile(std::vector<double> values, double q) {
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(q * (values.size() - 1) + 0.5))];
+}
+
+class Harness {
+    BenchOptions options;
+    std::vector<BenchResult> results;
+
+public:
+    explicit Harness(const BenchOptions& opts) : options(opts) {}
+
+    // op(i) runs the kernel on input i of count; its result feeds a sink
+    // so the call cannot be optimized away.
+    template<typename Op>
+    void run(const std::string& name, const std::string& input, size_t count, Op op) {
+        if (!options.filter.empty() && (name + "/" + input).find(options.filter) == std::string::npos) return;
+
+        uint64_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) sink ^= op(i);
+        const double warm_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        const size_t block = std::max<size_t>(1, std::min<size_t>(count, static_cast<size_t>(1000.0 * count / std::max(warm_ns, 1.0))));
+
+        std::vector<double> ns_per_op, ticks_per_op;
+        double total_ns = 0;
+        for (size_t rep = 0; rep < options.reps; ++rep) {
+            for (size_t begin = 0; begin < count; begin += block) {
+                const size_t end = std::min(count, begin + block);
+                const uint64_t tsc_start = read_tsc();
+                const auto block_start = std::chrono::steady_clock::now();
+                for (size_t i = begin; i < end; ++i) sink ^= op(i);
+                const auto block_end = std::chrono::steady_clock::now();
+                const uint64_t tsc_end = read_tsc();
+
+                const double ns = std::chrono::duration<double, std::nano>(block_end - block_start).count();
+                total_ns += ns;
+                ns_per_op.push_back(ns / (end - begin));
+                ticks_per_op.push_back(static_cast<double>(tsc_end - tsc_start) / (end - begin));
+            }
+        }
+        g_sink = sink;
+
+        BenchResult result;
+        result.name = name;
+        result.input = input;
+        result.ops = count * options.reps;
+        result.median_ns = percentile(ns_per_op, 0.5);
+        result.p99_ns = percentile(ns_per_op, 0.99);
+        result.mean_ns = total_ns / result.ops;
+        result.cycles_per_op = percentile(ticks_per_op, 0.5);
+
+        std::cout << std::left << std::setw(28) << name << std::setw(20) << input
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << result.median_ns
+                  << std::setw(12) << result.p99_ns
+                  << std::setw(12) << result.cycles_per_op << "\n";
+        results.push_back(result);
+    }
+
+    bool write_json() const {
+        if (options.json_path.empty()) return true;
+        std::ofstream out(options.json_path);
+        if (!out) {
+            std::cerr << "Cannot open " << options.json_path << "\n";
+            return false;
+        }
+        out << "{\n  \"seed\": " << options.seed << ",\n  \"reps\": " << options.reps << ",\n  \"benchmarks\": [\n";
+        out << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"input\": \"" << r.input << "\", \"ops\": " << r.ops
+                << ", \"median_ns\": " << r.median_ns << ", \"p99_ns\": " << r.p99_ns
+                << ", \"mean_ns\": " << r.mean_ns << ", \"cycles_per_op\": " << r.cycles_per_op << "}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+};
+
+std::vector<uint64_t> uniform_inputs(StreamRNG& rng, size_t count, uint64_t lo, uint64_t hi, bool odd = false) {
+    std::vector<uint64_t> values(count);
+    for (auto& v : values) {
+        v = rng.uniform(lo, hi);
+        if (odd) v |= 1;
+    }
+    return values;
+}
+
+uint64_t random_prime(StreamRNG& rng, uint64_t lo, uint64_t hi) {
+    while (true) {
+        uint64_t candidate = rng.uniform(lo, hi) | 1;
+        if (number_theory::is_prime_u64(candidate)) return candidate;
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    using namespace number_theory;
+
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--reps" && i + 1 < argc) options.reps = std::max<size_t>(1, std::stoul(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc) options.seed = std::stoull(argv[++i]);
+        else if (arg == "--filter" && i + 1 < argc) options.filter = argv[++i];
+        else if (arg == "--json" && i + 1 < argc) options.json_path = argv[++i];
+        else {
+            std::cerr << "usage: " << argv[0] << " [--reps N] [--seed S] [--filter TEXT] [--json FILE]\n";
+            return 1;
+        }
+    }
+
+    StreamRNG rng(options.seed);
+    Harness bench(options);
+    std::cout << std::left << std::setw(28) << "kernel" << std::setw(20) << "input"
+              << std::right << std::setw(12) << "median ns" << std::setw(12) << "p99 ns"
+              << std::setw(12) << "cycles/op" << "\n";
+
+    // Modular exponentiation: full 64-bit exponents against small moduli
+    // (the tester's common case) and moduli up to 2^62.
+    const size_t POW_INPUTS = 4096;
+    for (auto [label, lo, hi] : {std::make_tuple("n<2^20", uint64_t(3), uint64_t(1) << 20),
+                                 std::make_tuple("n<2^62", uint64_t(1) << 32, uint64_t(1) << 62)}) {
+        const auto moduli = uniform_inputs(rng, POW_INPUTS, lo, hi, true);
+        std::vector<uint64_t> bases(POW_INPUTS), exps(POW_INPUTS);
+        for (size_t i = 0; i < POW_INPUTS; ++i) {
+            bases[i] = rng.bounded(moduli[i]);
+            exps[i] = rng.next();
+        }
+        std::vector<MontgomeryModulus> monts;
+        monts.reserve(POW_INPUTS);
+        for (uint64_t n : moduli) monts.emplace_back(n);
+
+        bench.run("mod_pow", label, POW_INPUTS, [&](size_t i) { return mod_pow(bases[i], exps[i], moduli[i]); });
+        bench.run("mod_pow_montgomery", label, POW_INPUTS,
+                  [&](size_t i) { return mod_pow_montgomery(bases[i], exps[i], monts[i]); });
+        bench.run("MontgomeryModulus()", label, POW_INPUTS,
+                  [&](size_t i) { return MontgomeryModulus(moduli[i]).to_montgomery(1); });
+    }
+
+    // Primality: random odd 64-bit numbers are mostly rejected by trial
+    // division or the first base; primes run every base.
+    const size_t PRIME_INPUTS = 2048;
+    const auto odd64 = uniform_inputs(rng, PRIME_INPUTS, uint64_t(1) << 32, ~uint64_t(0), true);
+    std::vector<uint64_t> primes64(PRIME_INPUTS);
+    for (auto& p : primes64) p = random_prime(rng, uint64_t(1) << 62, ~uint64_t(0));
+    bench.run("is_prime_miller_rabin", "random odd 64-bit", PRIME_INPUTS,
+              [&](size_t i) { return uint64_t(is_prime_miller_rabin(odd64[i])); });
+    bench.run("is_prime_miller_rabin", "64-bit primes", PRIME_INPUTS,
+              [&](size_t i) { return uint64_t(is_prime_miller_rabin(primes64[i])); });
+    bench.run("is_prime_u64", "random odd 64-bit", PRIME_INPUTS,
+              [&](size_t i) { return uint64_t(is_prime_u64(odd64[i])); });
+    bench.run("is_prime_u64", "64-bit primes", PRIME_INPUTS,
+              [&](size_t i) { return uint64_t(is_prime_u64(primes64[i])); });
+
+    // Pollard rho on balanced semiprimes, the hard case for factorization.
+    // Floyd is the original implementation, kept for comparison on the
+    // smaller inputs only; rho_bench compares the two at 62 bits.
+    const size_t RHO_INPUTS = 256;
+    for (auto [label, bits] : {std::make_pair("40-bit semiprimes", 20), std::make_pair("62-bit semiprimes", 31)}) {
+        std::vector<uint64_t> semiprimes(RHO_INPUTS);
+        for (auto& n : semiprimes) {
+            const uint64_t lo = uint64_t(1) << (bits - 1), hi = (uint64_t(1) << bits) - 1;
+            n = random_prime(rng, lo, hi) * random_prime(rng, lo, hi);
+        }
+        bench.run("pollard_rho_factor", label, RHO_INPUTS, [&](size_t i) { return pollard_rho_factor(semiprimes[i]); });
+        if (bits <= 20) {
+            bench.run("pollard_rho_floyd", label, RHO_INPUTS, [&](size_t i) { return pollard_rho_floyd(semiprimes[i]); });
+        }
+    }
+
+    // Totient and Carmichael function: uniform n, so the mix of smooth
+    // numbers, primes and hard composites matches a tester sweep. Neither
+    // keeps a memo, so every pass recomputes. The small range is timed again
+    // once an SPF table covers it.
+    const size_t PHI_INPUTS = 4096, PHI_WIDE_INPUTS = 512;
+    const uint64_t SMALL_BOUND = 1000000;
+    const auto small_n = uniform_inputs(rng, PHI_INPUTS, 2, SMALL_BOUND);
+    const auto wide_n = uniform_inputs(rng, PHI_WIDE_INPUTS, uint64_t(1) << 32, uint64_t(1) << 62);
+    bench.run("euler_phi", "n<1e6", PHI_INPUTS, [&](size_t i) { return euler_phi(small_n[i]); });
+    bench.run("carmichael_lambda", "n<1e6", PHI_INPUTS, [&](size_t i) { return carmichael_lambda(small_n[i]); });
+    bench.run("euler_phi", "2^32<n<2^62", PHI_WIDE_INPUTS, [&](size_t i) { return euler_phi(wide_n[i]); });
+    bench.run("carmichael_lambda", "2^32<n<2^62", PHI_WIDE_INPUTS,
+              [&](size_t i) { return carmichael_lambda(wide_n[i]); });
+
+    install_spf_table(SMALL_BOUND + 1, 1);
+    bench.run("euler_phi", "n<1e6 spf", PHI_INPUTS, [&](size_t i) { return euler_phi(small_n[i]); });
+    bench.run("carmichael_lambda", "n<1e6 spf", PHI_INPUTS, [&](size_t i) { return carmichael_lambda(small_n[i]); });
+
+    return bench.write_json() ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "complex_analysis.h"
+#include "rng.h"
+
+// Cost of e^(i theta) against the magnitude of theta. Each row draws
+// random theta of one magnitude and times reduce_pi_over_2,
+// exp_taylor_adaptive(i theta), exp_i_batch and std::cos + std::sin per
+// sample; err is the largest |e^(i theta) - (cosl + i sinl)| of
+// exp_taylor_adaptive. With Payne-Hanek reduction the first three columns
+// stay flat from 1 to 1e300. A final check runs z with a nonzero real
+// part, which is reduced the same way and scaled by e^(Re z).
+//   usage: reduction_bench [samples] [seed]
+
+namespace {
+
+using complex_analysis::Complex;
+using complex_analysis::Real;
+
+volatile double g_sink;
+
+template<typename Op>
+double time_per_sample(size_t samples, Op op) {
+    double sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; ++i) sink += op(i);
+    auto end = std::chrono::steady_clock::now();
+    g_sink = sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / samples;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t samples = (argc > 1) ? std::stoul(argv[1]) : 20000;
+    uint64_t seed = (argc > 2) ? std::stoull(argv[2]) : 42;
+
+    StreamRNG rng(seed);
+    std::vector<double> theta(samples), re(samples), im(samples);
+
+    std::cout << "e^(i theta) over " << samples << " random theta per magnitude (seed " << seed << "), ns/sample\n";
+    std::cout << std::left << std::setw(10) << "|theta|" << std::right
+              << std::setw(10) << "reduce" << std::setw(10) << "taylor" << std::setw(10) << "batch"
+              << std::setw(10) << "libm" << std::setw(12) << "err" << "\n";
+
+    for (double magnitude : {1.0, 1e1, 1e3, 1e6, 1e9, 1e15, 1e30, 1e100, 1e300}) {
+        for (auto& t : theta) t = magnitude * rng.uniform(1.0, 2.0) * (rng.next() & 1 ? 1 : -1);
+
+        const double reduce_ns = time_per_sample(samples, [&](size_t i) {
+            int quadrant;
+            return static_cast<double>(complex_analysis::reduce_pi_over_2(theta[i], quadrant)) + quadrant;
+        });
+        const double taylor_ns = time_per_sample(samples, [&](size_t i) {
+            return static_cast<double>(complex_analysis::exp_taylor_adaptive(Complex(0.0L, theta[i])).real());
+        });
+        auto start = std::chrono::steady_clock::now();
+        complex_analysis::exp_i_batch(theta.data(), samples, re.data(), im.data());
+        const double batch_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / samples;
+        const double libm_ns = time_per_sample(samples, [&](size_t i) { return std::cos(theta[i]) + std::sin(theta[i]); });
+
+        Real max_error = 0;
+        for (size_t i = 0; i < samples; i += 16) {
+            const Complex value = complex_analysis::exp_taylor_adaptive(Complex(0.0L, theta[i]));
+            max_error = std::max(max_error, std::abs(value - Complex(cosl(theta[i]), sinl(theta[i]))));
+        }
+
+        std::cout << std::left << std::setw(10) << std::defaultfloat << std::setprecision(3) << magnitude << std::right
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(10) << reduce_ns << std::setw(10) << taylor_ns
+                  << std::setw(10) << batch_ns << std::setw(10) << libm_ns
+                  << std::scientific << std::setprecision(2) << std::setw(12) << static_cast<double>(max_error) << "\n";
+    }
+
+    Real max_relative = 0;
+    bool accurate = true;
+    for (const Complex z : {Complex(0.5L, -1e300L), Complex(50.0L, 1e10L), Complex(-3.0L, 7.0L), Complex(1e-3L, -1e15L)}) {
+        const Complex expected = std::exp(z.real()) * Complex(cosl(z.imag()), sinl(z.imag()));
+        const Complex value = complex_analysis::exp_taylor_adaptive(z);
+        const Real relative = std::abs(value - expected) / std::abs(expected);
+        accurate &= relative < 1e-15L;
+        max_relative = std::max(max_relative, relative);
+    }
+    std::cout << "complex z, largest relative err " << std::scientific << std::setprecision(2)
+              << static_cast<double>(max_relative) << "\n";
+    return accurate ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "number_theory.h"
+#include "rng.h"
+
+// Compares Brent rho against the original Floyd rho on random 62-bit
+// semiprimes (two 31-bit prime factors).
+//   usage: rho_bench [samples] [seed]
+
+namespace {
+
+uint64_t random_prime_31(SecureRNG& rng) {
+    while (true) {
+        uint64_t candidate = rng.uniform(static_cast<uint64_t>(1) << 30, (static_cast<uint64_t>(1) << 31) - 1) | 1;
+        if (number_theory::is_prime_u64(candidate)) return candidate;
+    }
+}
+
+template<typename Factor>
+double time_factor(const char* name, Factor factor, const std::vector<uint64_t>& inputs) {
+    size_t failures = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t n : inputs) {
+        uint64_t d = factor(n);
+        if (d <= 1 || d >= n || n % d != 0) failures++;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double us_per_op = 1e6 * seconds / inputs.size();
+    std::cout << std::left << std::setw(8) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << us_per_op << " us/op"
+              << std::setw(10) << failures << " failures\n";
+    return us_per_op;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t samples = (argc > 1) ? std::stoul(argv[1]) : 2000;
+    uint64_t seed = (argc > 2) ? std::stoull(argv[2]) : 42;
+
+    SecureRNG rng(seed);
+    std::vector<uint64_t> semiprimes(samples);
+    for (auto& n : semiprimes) n = random_prime_31(rng) * random_prime_31(rng);
+
+    std::cout << "Pollard rho on " << samples << " random 62-bit semiprimes (seed " << seed << ")\n";
+    double floyd = time_factor("floyd", number_theory::pollard_rho_floyd, semiprimes);
+    double brent = time_factor("brent", number_theory::pollard_rho_factor, semiprimes);
+    std::cout << "speedup  " << std::setprecision(2) << floyd / brent << "x\n";
+    return 0;
+}
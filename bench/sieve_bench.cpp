@@ -0,0 +1,59 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "sieve.h"
+
+// Checks every SegmentedSieve entry point against trial division for all
+// ranges [lower, upper) with lower in 0..100 (the range holding the wheel
+// and pattern primes), then times count_primes(0, limit).
+//   usage: sieve_bench [limit] [threads]
+
+namespace {
+
+bool is_prime_slow(uint64_t n) {
+    if (n < 2) return false;
+    for (uint64_t d = 2; d * d <= n; ++d) {
+        if (n % d == 0) return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    uint64_t limit = (argc > 1) ? std::stoull(argv[1]) : 1000000000ULL;
+    size_t threads = (argc > 2) ? std::stoul(argv[2]) : 0;
+
+    const number_theory::SegmentedSieve sieve(threads);
+    const uint64_t MAX_LOWER = 100, MAX_UPPER = 400;
+    std::vector<uint64_t> prefix(MAX_UPPER + 1, 0);
+    for (uint64_t n = 0; n < MAX_UPPER; ++n) prefix[n + 1] = prefix[n] + is_prime_slow(n);
+
+    size_t failures = 0;
+    for (uint64_t lower = 0; lower <= MAX_LOWER; ++lower) {
+        for (uint64_t upper = lower; upper <= MAX_UPPER; ++upper) {
+            const uint64_t expected = prefix[upper] - prefix[lower];
+            const auto bits = sieve.sieve_range(lower, upper);
+            const auto list = sieve.primes(lower, upper);
+            number_theory::PrimeIterator it(lower, upper);
+            uint64_t p, walked = 0;
+            bool ok = sieve.count_primes(lower, upper) == expected && bits.count() == expected &&
+                      list.size() == expected;
+            for (uint64_t n = lower; n < upper; ++n) ok &= bits.test(n) == is_prime_slow(n);
+            for (uint64_t q : list) ok &= is_prime_slow(q) && q >= lower && q < upper;
+            while (it.next(p)) ok &= is_prime_slow(p) && p >= lower && p < upper && ++walked <= expected;
+            ok &= walked == expected;
+            if (!ok && ++failures <= 10) std::cout << "  FAILED: [" << lower << ", " << upper << ")\n";
+        }
+    }
+    std::cout << "boundary check, lower 0.." << MAX_LOWER << ": "
+              << (failures == 0 ? "all ranges match trial division\n" : "FAILED\n");
+
+    auto start = std::chrono::steady_clock::now();
+    const uint64_t count = sieve.count_primes(0, limit);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "pi(" << limit << ") = " << count << " in " << std::fixed << std::setprecision(3) << seconds << " s\n";
+    return failures == 0 ? 0 : 1;
+}
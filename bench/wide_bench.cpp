@@ -0,0 +1,124 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include "multiprecision.h"
+#include "number_theory.h"
+#include "rng.h"
+
+// Checks and times the multi-limb Montgomery arithmetic at 128 and 256
+// bits: pow against the 64-bit mod_pow on small moduli, Fermat on known
+// primes, random_below's range, overflow detection, and
+// test_euler_theorem_wide on 2^k p q with random primes p, q.
+//   usage: wide_bench [samples] [seed]
+
+namespace {
+
+using number_theory::UInt;
+
+size_t failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        failures++;
+        std::cout << "  FAILED: " << what << "\n";
+    }
+}
+
+template<size_t N>
+UInt<N> random_bits(StreamRNG& rng, size_t bits) {
+    UInt<N> x;
+    rng.fill(x.limb.data(), (bits + 63) / 64);
+    if (bits % 64) x.limb[(bits - 1) / 64] &= (1ULL << (bits % 64)) - 1;
+    x.limb[(bits - 1) / 64] |= 1ULL << ((bits - 1) % 64);
+    return x;
+}
+
+template<size_t N>
+UInt<N> random_prime(StreamRNG& rng, size_t bits) {
+    while (true) {
+        UInt<N> p = random_bits<N>(rng, bits);
+        p.limb[0] |= 1;
+        if (number_theory::is_prime_miller_rabin(p)) return p;
+    }
+}
+
+template<size_t N>
+void run(const char* prime_text, size_t samples, StreamRNG& rng) {
+    const size_t bits = 64 * N;
+    std::cout << bits << "-bit\n";
+
+    for (size_t i = 0; i < samples; ++i) {
+        const uint64_t n = (rng.bounded(UINT64_C(1) << 62) + 3) | 1;
+        const uint64_t a = rng.bounded(n), e = rng.next();
+        UInt<N> exp;
+        exp.limb[0] = e;
+        const number_theory::Montgomery<N> mont{UInt<N>(n)};
+        if (mont.pow(UInt<N>(a), exp) != UInt<N>(number_theory::mod_pow(a, e, n))) {
+            check(false, "pow matches 64-bit mod_pow");
+            break;
+        }
+    }
+
+    const UInt<N> prime = UInt<N>::from_string(prime_text);
+    check(number_theory::is_prime_miller_rabin(prime), "known prime passes Miller-Rabin");
+    UInt<N> p_minus_1 = prime;
+    p_minus_1.sub(UInt<N>(1));
+    const number_theory::Montgomery<N> mont(prime);
+    bool fermat = true;
+    for (uint64_t a = 2; a < 50; ++a) fermat &= mont.pow(UInt<N>(a), p_minus_1) == UInt<N>(1);
+    check(fermat, "a^(p-1) = 1 mod known prime");
+
+    bool in_range = true, hit_top = false;
+    for (int i = 0; i < 200; ++i) {
+        const UInt<N> x = number_theory::random_below(UInt<N>(5), rng);
+        in_range &= x == UInt<N>(2) || x == UInt<N>(3);
+        hit_top |= x == UInt<N>(3);
+    }
+    check(in_range && hit_top, "random_below(5) covers [2, 3]");
+
+    std::map<UInt<N>, int> too_big{{UInt<N>(2), 3}, {prime, 2}};
+    bool threw = false;
+    try {
+        number_theory::test_euler_theorem_wide(too_big, 1, rng);
+    } catch (const std::overflow_error&) {
+        threw = true;
+    }
+    check(threw, "oversized factorisation throws overflow_error");
+
+    // pow timing with full-width base and exponent.
+    UInt<N> acc(0);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; ++i) {
+        const UInt<N> a = number_theory::random_below(prime, rng);
+        acc.add(mont.pow(a, random_bits<N>(rng, bits - 1)));
+    }
+    const double pow_us = 1e6 * std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / samples;
+
+    std::map<UInt<N>, int> factors{{UInt<N>(2), 5}, {random_prime<N>(rng, bits / 2 - 4), 1},
+                                   {random_prime<N>(rng, bits / 2 - 4), 1}};
+    const auto result = number_theory::test_euler_theorem_wide(factors, samples, rng);
+    check(result.total_tests > 0 && result.passed_tests == result.total_tests, "Euler's theorem on 2^5 p q");
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "  pow            " << std::setw(10) << pow_us << " us/op  (checksum " << acc.low() % 1000 << ")\n"
+              << "  euler 2^5 p q  " << std::setw(10) << 1e6 * result.avg_computation_time / samples << " us/test  ("
+              << result.passed_tests << "/" << result.total_tests << " passed)\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t samples = (argc > 1) ? std::stoul(argv[1]) : 2000;
+    uint64_t seed = (argc > 2) ? std::stoull(argv[2]) : 42;
+    StreamRNG rng(seed);
+
+    std::cout << "Wide Montgomery arithmetic, " << samples << " samples (seed " << seed << ")\n";
+    run<2>("170141183460469231731687303715884105727", samples, rng);  // 2^127 - 1
+    run<4>("57896044618658097711785492504343953926634992332820282019728792003956564819949", samples, rng);  // 2^255 - 19
+
+    std::cout << (failures == 0 ? "all checks passed\n" : "checks FAILED\n");
+    return failures == 0 ? 0 : 1;
+}
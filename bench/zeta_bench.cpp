@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "zeta.h"
+
+// Times the zeta engine on a domain-coloring grid over [-10, 10] x
+// [-30, 30]: per-point riemann_zeta, the row-shared riemann_zeta_grid, and
+// the old 1000-term direct sum on the Re s > 1 part it covered. Also
+// checks zeta at the first nontrivial zero and Z(t) at large t.
+//   usage: zeta_bench [resolution] [threads]
+
+namespace {
+
+using complex_analysis::Complex;
+using complex_analysis::Real;
+
+// The previous header-only riemann_zeta, kept for comparison.
+Complex direct_sum_zeta(Complex s) {
+    Complex sum = 0.0L;
+    for (int n = 1; n <= 1000; n++) {
+        Complex term = Complex(1.0L) / std::pow(Complex(n, 0), s);
+        sum += term;
+        if (std::abs(term) < 1e-10) break;
+    }
+    return sum;
+}
+
+template<typename Fn>
+double seconds_for(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t resolution = (argc > 1) ? std::stoul(argv[1]) : 2000;
+    size_t threads = (argc > 2) ? std::stoul(argv[2]) : 0;
+    if (resolution < 2) {
+        std::cerr << "resolution must be at least 2\n";
+        return 1;
+    }
+
+    const Real X_MIN = -10, X_MAX = 10, Y_MIN = -30, Y_MAX = 30;
+    const size_t points = resolution * resolution;
+    std::vector<Complex> grid(points);
+    volatile Real sink = 0;
+
+    std::cout << "Riemann zeta on a " << resolution << "x" << resolution << " grid over [-10, 10] x [-30, 30]\n";
+    std::cout << std::fixed << std::setprecision(1);
+
+    // Per-point timings on an evenly spaced sample of the grid. Small grids
+    // repeat points rather than collapsing the sample onto index 0.
+    const size_t SAMPLE = 20000;
+    auto sample_index = [&](size_t k) { return k * points / SAMPLE; };
+    auto sample_point = [&](size_t k, Real x_min) {
+        const size_t index = sample_index(k);
+        return Complex(x_min + (X_MAX - x_min) * (index % resolution) / (resolution - 1),
+                       Y_MIN + (Y_MAX - Y_MIN) * (index / resolution) / (resolution - 1));
+    };
+    const double scalar = seconds_for([&] {
+        for (size_t k = 0; k < SAMPLE; ++k) sink = sink + complex_analysis::riemann_zeta(sample_point(k, X_MIN)).real();
+    });
+    const double direct = seconds_for([&] {
+        for (size_t k = 0; k < SAMPLE; ++k) sink = sink + direct_sum_zeta(sample_point(k, 1.1L)).real();
+    });
+    std::cout << std::left << std::setw(22) << "riemann_zeta" << std::right << std::setw(12) << 1e9 * scalar / SAMPLE
+              << " ns/point\n";
+    std::cout << std::left << std::setw(22) << "direct sum (Re s>1)" << std::right << std::setw(12)
+              << 1e9 * direct / SAMPLE << " ns/point\n";
+
+    const double grid_seconds = seconds_for([&] {
+        complex_analysis::riemann_zeta_grid(X_MIN, X_MAX, Y_MIN, Y_MAX, resolution, resolution, grid.data(), threads);
+    });
+    std::cout << std::left << std::setw(22) << "riemann_zeta_grid" << std::right << std::setw(12)
+              << 1e9 * grid_seconds / points << " ns/point" << std::setprecision(3) << std::setw(10) << grid_seconds
+              << " s total\n";
+
+    // Spot checks: the grid against per-point calls, the first zero, and
+    // Riemann-Siegel at large t.
+    Real worst = 0;
+    for (size_t k = 0; k < SAMPLE; k += 97) {
+        const size_t index = sample_index(k);
+        const Complex expected = complex_analysis::riemann_zeta(sample_point(k, X_MIN));
+        worst = std::max(worst, std::abs(grid[index] - expected) / std::max<Real>(1, std::abs(expected)));
+    }
+    std::cout << std::scientific << std::setprecision(2);
+    std::cout << "grid vs riemann_zeta  " << static_cast<double>(worst) << " max relative difference\n";
+    std::cout << "|zeta(1/2 + 14.1347i)| "
+              << static_cast<double>(std::abs(complex_analysis::riemann_zeta(Complex(0.5L, 14.134725141734693790L))))
+              << "\n";
+    const double rs = seconds_for([&] { sink = sink + complex_analysis::riemann_siegel_z(1e10L); });
+    std::cout << "Z(1e10) = " << static_cast<double>(complex_analysis::riemann_siegel_z(1e10L)) << " in "
+              << std::fixed << std::setprecision(1) << 1e6 * rs << " us\n";
+    return 0;
+}
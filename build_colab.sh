@@ -16,8 +16,8 @@ echo "Skipping Qt dependencies for headless environment"
 # Set optimal compiler flags for Colab environment
 export CC=gcc
 export CXX=g++
-export CXXFLAGS="-O3 -march=native -mtune=native -flto -funroll-loops -ffast-math -DNDEBUG -fopenmp"
-export LDFLAGS="-flto -fopenmp"
+export CXXFLAGS="-O3 -march=native -mtune=native -flto -funroll-loops -ffast-math -DNDEBUG -pthread"
+export LDFLAGS="-flto -pthread"
 
 # Create optimized build directory
 mkdir -p build_colab
@@ -55,7 +55,7 @@ else
     g++ $CXXFLAGS \
         -Iinclude \
         -DVTK_FOUND=0 \
-        src/main.cpp src/number_theory.cpp src/complex_analysis.cpp \
+        src/main.cpp src/number_theory.cpp src/sieve.cpp src/scheduler.cpp src/thread_pool.cpp src/result_io.cpp src/result_sink.cpp src/pseudoprime.cpp src/complex_analysis.cpp src/zeta.cpp \
         src/topology.cpp src/progress.cpp src/rng.cpp src/visualization.cpp \
         -o build_colab/euler
     cd build_colab
@@ -74,7 +74,7 @@ fi
 g++ $CXXFLAGS \
     -Iinclude \
     -DVTK_FOUND=0 \
-    src/main.cpp src/number_theory.cpp src/complex_analysis.cpp \
+    src/main.cpp src/number_theory.cpp src/sieve.cpp src/scheduler.cpp src/thread_pool.cpp src/result_io.cpp src/result_sink.cpp src/pseudoprime.cpp src/complex_analysis.cpp src/zeta.cpp \
     src/topology.cpp src/progress.cpp src/rng.cpp src/visualization.cpp \
     $ULTRA_PRECISION \
     -o build_colab/euler_lite 2>/dev/null
@@ -86,7 +86,7 @@ else
     g++ $CXXFLAGS \
         -Iinclude \
         -DVTK_FOUND=0 -DNO_VISUALIZATION=1 \
-        src/main.cpp src/number_theory.cpp src/complex_analysis.cpp \
+        src/main.cpp src/number_theory.cpp src/sieve.cpp src/scheduler.cpp src/thread_pool.cpp src/result_io.cpp src/result_sink.cpp src/pseudoprime.cpp src/complex_analysis.cpp src/zeta.cpp \
         src/topology.cpp src/progress.cpp src/rng.cpp \
         $ULTRA_PRECISION \
         -o build_colab/euler_lite
@@ -97,7 +97,7 @@ echo "Creating basic computation version..."
 g++ $CXXFLAGS \
     -Iinclude \
     -DVTK_FOUND=0 -DBASIC_BUILD=1 \
-    src/main.cpp src/number_theory.cpp src/complex_analysis.cpp \
+    src/main.cpp src/number_theory.cpp src/sieve.cpp src/scheduler.cpp src/thread_pool.cpp src/result_io.cpp src/result_sink.cpp src/pseudoprime.cpp src/complex_analysis.cpp src/zeta.cpp \
     src/topology.cpp src/progress.cpp src/rng.cpp src/visualization.cpp \
     $ULTRA_PRECISION \
     -o build_colab/euler_basic 2>/dev/null
@@ -107,7 +107,7 @@ if [ $? -ne 0 ]; then
     g++ $CXXFLAGS \
         -Iinclude \
         -DVTK_FOUND=0 -DNO_VISUALIZATION=1 \
-        src/main.cpp src/number_theory.cpp src/complex_analysis.cpp \
+        src/main.cpp src/number_theory.cpp src/sieve.cpp src/scheduler.cpp src/thread_pool.cpp src/result_io.cpp src/result_sink.cpp src/pseudoprime.cpp src/complex_analysis.cpp src/zeta.cpp \
         src/topology.cpp src/progress.cpp src/rng.cpp \
         $ULTRA_PRECISION \
         -o build_colab/euler_basic
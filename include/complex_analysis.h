@@ -1,5 +1,7 @@
 #pragma once
+#include <array>
 #include <complex>
+#include <cstdint>
 #include <vector>
 #include "config.h"
 
@@ -15,36 +17,73 @@ namespace complex_analysis {
         Real get() const { return sum; }
     };
     
+    // For finite Re z, Im z is first reduced by reduce_pi_over_2, so the
+    // series always runs on i r with |r| <= pi/4 and e^(Re z) scales it.
     Complex exp_taylor_adaptive(Complex z, Real tolerance = config::TAYLOR_CONVERGENCE);
     
+    // theta = k pi/2 + r with |r| <= pi/4; quadrant = k mod 4. Payne-Hanek:
+    // the 64-bit mantissa is multiplied by the 256 bits of a stored 2/pi
+    // expansion that matter at theta's exponent, so the cost is the same for
+    // every finite long double. Non-finite theta gives NaN.
+    Real reduce_pi_over_2(Real theta, int& quadrant);
+    
+    // re[i] + i im[i] = e^(i theta[i]) in double precision, for count
+    // angles. theta is reduced by Cody-Waite to r in [-pi/4, pi/4] plus a
+    // quadrant, then fixed-degree sin and cos polynomials in r run in SIMD
+    // lanes (AVX2 with FMA when compiled for it). Angles beyond
+    // EXP_I_REDUCTION_LIMIT, where the three-part pi/2 stops being exact, are
+    // reduced by reduce_pi_over_2 instead. exp_taylor_adaptive stays the
+    // reference.
+    constexpr double EXP_I_REDUCTION_LIMIT = 1647099.0;  // about 2^20 * pi/2
+    void exp_i_batch(const double* theta, size_t count, double* re, double* im);
+    
+    // One-pass error statistics in constant memory: count, min/max, Welford
+    // mean and variance, and an HDR-style log histogram with SUB_BUCKETS
+    // linear buckets per power of two from 2^MIN_EXPONENT to 2^MAX_EXPONENT.
+    // Bucket 0 holds zero and anything smaller, the last bucket anything
+    // larger. Instances merge exactly (Chan et al.), so each thread or block
+    // keeps its own and they are combined afterwards.
+    class StreamingErrorStats {
+    public:
+        static constexpr int MIN_EXPONENT = -96, MAX_EXPONENT = 16, SUB_BUCKETS = 8;
+        static constexpr size_t BUCKETS = (MAX_EXPONENT - MIN_EXPONENT) * SUB_BUCKETS + 2;
+        
+        void add(Real value);
+        void merge(const StreamingErrorStats& other);
+        
+        uint64_t count() const { return n; }
+        Real min() const { return n ? min_value : 0.0L; }
+        Real max() const { return n ? max_value : 0.0L; }
+        Real mean() const { return mean_value; }
+        // Sample variance, divided by count - 1.
+        Real variance() const { return n > 1 ? m2 / static_cast<Real>(n - 1) : 0.0L; }
+        Real std_deviation() const;
+        // Smallest bucket bound below which a fraction q of the samples lie,
+        // clamped to [min, max]; accurate to one bucket (12.5%).
+        Real quantile(double q) const;
+        
+        const std::array<uint64_t, BUCKETS>& buckets() const { return histogram; }
+        static Real bucket_lower_bound(size_t index);
+        
+    private:
+        uint64_t n = 0;
+        Real mean_value = 0.0L, m2 = 0.0L;
+        Real min_value = 0.0L, max_value = 0.0L;
+        std::array<uint64_t, BUCKETS> histogram{};
+    };
+    
     struct ComplexBenchmark {
         size_t samples;
         Real max_absolute_error;
         Real mean_absolute_error;
         Real std_deviation_error;
         Real computation_time_seconds;
-        std::vector<Real> error_histogram;
+        StreamingErrorStats error_stats;
     };
     
-    ComplexBenchmark benchmark_euler_formula(size_t num_samples);
-    
-    // Riemann zeta function for visualization
-    inline Complex riemann_zeta(Complex s) {
-        // Simple implementation for visualization purposes
-        // Valid for Re(s) > 1
-        Complex sum = 0.0;
-        int max_terms = 1000;
-        
-        for (int n = 1; n <= max_terms; n++) {
-            Complex n_complex(n, 0);
-            Complex term = Complex(1.0) / std::pow(n_complex, s);
-            sum += term;
-            
-            // Early termination when terms become sufficiently small
-            if (std::abs(term) < 1e-10)
-                break;
-        }
-        
-        return sum;
-    }
+    // Errors of exp_taylor_adaptive(i theta) against std::cos/std::sin for
+    // random theta. Runs on the thread pool (num_threads = 0: all cores)
+    // and gives bit-identical results for a given seed at any thread count.
+    ComplexBenchmark benchmark_euler_formula(size_t num_samples, size_t num_threads = 0,
+                                             uint64_t seed = config::RNG_DEFAULT_SEED);
 }
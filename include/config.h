@@ -1,5 +1,6 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
 #include <thread>
 
 namespace config {
@@ -9,6 +10,7 @@ namespace config {
     constexpr size_t TAYLOR_MAX_TERMS = 500;
     constexpr long double TAYLOR_CONVERGENCE = 1e-25L;
     constexpr size_t MAX_ICOSPHERE_LEVEL = 6;
+    constexpr uint64_t RNG_DEFAULT_SEED = 0x5DEECE66D2F1A3B9ULL;
     
     inline int get_thread_count() {
         return std::thread::hardware_concurrency();
@@ -0,0 +1,447 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "config.h"
+#include "rng.h"
+
+namespace number_theory {
+    // Fixed-width unsigned integer of N little-endian 64-bit limbs. All loops
+    // run over the compile-time N, so the optimizer unrolls them completely.
+    template<size_t N>
+    struct UInt {
+        std::array<uint64_t, N> limb{};
+
+        UInt() = default;
+        UInt(uint64_t value) { limb[0] = value; }
+
+        // Decimal, or hexadecimal with a 0x prefix.
+        static UInt from_string(const std::string& text) {
+            UInt result;
+            const bool hex = text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X');
+            const uint64_t base = hex ? 16 : 10;
+            for (size_t i = hex ? 2 : 0; i < text.size(); ++i) {
+                const char c = text[i];
+                uint64_t digit;
+                if (c >= '0' && c <= '9') digit = c - '0';
+                else if (hex && c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+                else if (hex && c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+                else throw std::invalid_argument("UInt: bad digit in '" + text + "'");
+                if (result.mul_small(base, digit) != 0) throw std::overflow_error("UInt: '" + text + "' does not fit");
+            }
+            return result;
+        }
+
+        std::string to_string() const {
+            if (is_zero()) return "0";
+            UInt x = *this;
+            std::string digits;
+            while (!x.is_zero()) {
+                uint64_t chunk = x.div_small(10000000000000000000ULL);
+                for (int i = 0; i < 19 && (chunk != 0 || !x.is_zero()); ++i) {
+                    digits.push_back(static_cast<char>('0' + chunk % 10));
+                    chunk /= 10;
+                }
+            }
+            return std::string(digits.rbegin(), digits.rend());
+        }
+
+        bool is_zero() const {
+            uint64_t any = 0;
+            for (size_t i = 0; i < N; ++i) any |= limb[i];
+            return any == 0;
+        }
+        bool is_odd() const { return limb[0] & 1; }
+        uint64_t low() const { return limb[0]; }
+        bool bit(size_t i) const { return (limb[i / 64] >> (i % 64)) & 1; }
+
+        size_t bit_length() const {
+            for (size_t i = N; i-- > 0;) {
+                if (limb[i]) return 64 * i + 64 - __builtin_clzll(limb[i]);
+            }
+            return 0;
+        }
+
+        // this += other, returns the carry out.
+        uint64_t add(const UInt& other) {
+            __uint128_t carry = 0;
+            for (size_t i = 0; i < N; ++i) {
+                carry += static_cast<__uint128_t>(limb[i]) + other.limb[i];
+                limb[i] = static_cast<uint64_t>(carry);
+                carry >>= 64;
+            }
+            return static_cast<uint64_t>(carry);
+        }
+
+        // this -= other, returns the borrow out.
+        uint64_t sub(const UInt& other) {
+            uint64_t borrow = 0;
+            for (size_t i = 0; i < N; ++i) {
+                const __uint128_t diff = static_cast<__uint128_t>(limb[i]) - other.limb[i] - borrow;
+                limb[i] = static_cast<uint64_t>(diff);
+                borrow = static_cast<uint64_t>(diff >> 64) & 1;
+            }
+            return borrow;
+        }
+
+        // this = this * factor + addend, returns the limb shifted out.
+        uint64_t mul_small(uint64_t factor, uint64_t addend = 0) {
+            __uint128_t carry = addend;
+            for (size_t i = 0; i < N; ++i) {
+                carry += static_cast<__uint128_t>(limb[i]) * factor;
+                limb[i] = static_cast<uint64_t>(carry);
+                carry >>= 64;
+            }
+            return static_cast<uint64_t>(carry);
+        }
+
+        // this /= divisor, returns the remainder.
+        uint64_t div_small(uint64_t divisor) {
+            __uint128_t rem = 0;
+            for (size_t i = N; i-- > 0;) {
+                rem = (rem << 64) | limb[i];
+                limb[i] = static_cast<uint64_t>(rem / divisor);
+                rem %= divisor;
+            }
+            return static_cast<uint64_t>(rem);
+        }
+
+        uint64_t mod_small(uint64_t divisor) const {
+            __uint128_t rem = 0;
+            for (size_t i = N; i-- > 0;) rem = ((rem << 64) | limb[i]) % divisor;
+            return static_cast<uint64_t>(rem);
+        }
+
+        void shift_right(size_t bits) {
+            const size_t words = bits / 64, rest = bits % 64;
+            for (size_t i = 0; i < N; ++i) {
+                const uint64_t lo = i + words < N ? limb[i + words] : 0;
+                const uint64_t hi = i + words + 1 < N ? limb[i + words + 1] : 0;
+                limb[i] = rest ? (lo >> rest) | (hi << (64 - rest)) : lo;
+            }
+        }
+
+        size_t trailing_zeros() const {
+            for (size_t i = 0; i < N; ++i) {
+                if (limb[i]) return 64 * i + __builtin_ctzll(limb[i]);
+            }
+            return 64 * N;
+        }
+
+        friend bool operator==(const UInt& a, const UInt& b) { return a.limb == b.limb; }
+        friend bool operator!=(const UInt& a, const UInt& b) { return a.limb != b.limb; }
+        friend bool operator<(const UInt& a, const UInt& b) {
+            for (size_t i = N; i-- > 0;) {
+                if (a.limb[i] != b.limb[i]) return a.limb[i] < b.limb[i];
+            }
+            return false;
+        }
+        friend bool operator>=(const UInt& a, const UInt& b) { return !(a < b); }
+    };
+
+    using UInt128 = UInt<2>;
+    using UInt256 = UInt<4>;
+
+    // Low N limbs of a * b.
+    template<size_t N>
+    UInt<N> multiply_low(const UInt<N>& a, const UInt<N>& b) {
+        UInt<N> result;
+        for (size_t i = 0; i < N; ++i) {
+            __uint128_t carry = 0;
+            for (size_t j = 0; i + j < N; ++j) {
+                carry += static_cast<__uint128_t>(a.limb[j]) * b.limb[i] + result.limb[i + j];
+                result.limb[i + j] = static_cast<uint64_t>(carry);
+                carry >>= 64;
+            }
+        }
+        return result;
+    }
+
+    // a * b; throws std::overflow_error if the product needs more than N limbs.
+    template<size_t N>
+    UInt<N> multiply_checked(const UInt<N>& a, const UInt<N>& b) {
+        uint64_t t[2 * N] = {};
+        for (size_t i = 0; i < N; ++i) {
+            __uint128_t carry = 0;
+            for (size_t j = 0; j < N; ++j) {
+                carry += static_cast<__uint128_t>(a.limb[j]) * b.limb[i] + t[i + j];
+                t[i + j] = static_cast<uint64_t>(carry);
+                carry >>= 64;
+            }
+            t[i + N] = static_cast<uint64_t>(carry);
+        }
+        UInt<N> result;
+        for (size_t i = 0; i < N; ++i) {
+            if (t[N + i] != 0) throw std::overflow_error("UInt: product does not fit in " + std::to_string(64 * N) + " bits");
+            result.limb[i] = t[i];
+        }
+        return result;
+    }
+
+    template<size_t N>
+    UInt<N> binary_gcd(UInt<N> a, UInt<N> b) {
+        if (a.is_zero()) return b;
+        if (b.is_zero()) return a;
+        const size_t shift = std::min(a.trailing_zeros(), b.trailing_zeros());
+        a.shift_right(a.trailing_zeros());
+        while (!b.is_zero()) {
+            b.shift_right(b.trailing_zeros());
+            if (b < a) std::swap(a, b);
+            b.sub(a);
+        }
+        UInt<N> result = a;
+        for (size_t i = 0; i < shift; ++i) result.add(result);
+        return result;
+    }
+
+    // Montgomery arithmetic modulo an odd n < 2^(64N) with R = 2^(64N).
+    // multiply() is the CIOS (coarsely integrated operand scanning) product:
+    // one word of b is multiplied in and one word of the result reduced away
+    // per outer step, keeping the working value at N + 2 words.
+    template<size_t N>
+    class Montgomery {
+        UInt<N> n;
+        UInt<N> r_mod_n, r2_mod_n;
+        uint64_t n_inv;  // -n^-1 mod 2^64
+
+        // x = 2x mod n for x < n.
+        void double_mod(UInt<N>& x) const {
+            const uint64_t carry = x.add(x);
+            if (carry || x >= n) x.sub(n);
+        }
+
+    public:
+        explicit Montgomery(const UInt<N>& odd_modulus) : n(odd_modulus) {
+            if (!n.is_odd()) throw std::invalid_argument("Montgomery: modulus must be odd");
+            uint64_t inv = n.limb[0];
+            for (int i = 0; i < 5; ++i) inv *= 2 - n.limb[0] * inv;
+            n_inv = 0 - inv;
+
+            UInt<N> x(1);
+            if (x >= n) x.sub(n);
+            for (size_t i = 0; i < 64 * N; ++i) double_mod(x);
+            r_mod_n = x;
+            for (size_t i = 0; i < 64 * N; ++i) double_mod(x);
+            r2_mod_n = x;
+        }
+
+        const UInt<N>& modulus() const { return n; }
+        const UInt<N>& one() const { return r_mod_n; }
+
+        UInt<N> multiply(const UInt<N>& a, const UInt<N>& b) const {
+            uint64_t t[N + 2] = {};
+            for (size_t i = 0; i < N; ++i) {
+                __uint128_t carry = 0;
+                for (size_t j = 0; j < N; ++j) {
+                    carry += static_cast<__uint128_t>(a.limb[j]) * b.limb[i] + t[j];
+                    t[j] = static_cast<uint64_t>(carry);
+                    carry >>= 64;
+                }
+                carry += t[N];
+                t[N] = static_cast<uint64_t>(carry);
+                t[N + 1] = static_cast<uint64_t>(carry >> 64);
+
+                const uint64_t m = t[0] * n_inv;
+                carry = static_cast<__uint128_t>(m) * n.limb[0] + t[0];
+                carry >>= 64;
+                for (size_t j = 1; j < N; ++j) {
+                    carry += static_cast<__uint128_t>(m) * n.limb[j] + t[j];
+                    t[j - 1] = static_cast<uint64_t>(carry);
+                    carry >>= 64;
+                }
+                carry += t[N];
+                t[N - 1] = static_cast<uint64_t>(carry);
+                t[N] = t[N + 1] + static_cast<uint64_t>(carry >> 64);
+            }
+
+            UInt<N> result;
+            for (size_t j = 0; j < N; ++j) result.limb[j] = t[j];
+            if (t[N] || result >= n) result.sub(n);
+            return result;
+        }
+
+        UInt<N> to_montgomery(const UInt<N>& x) const { return multiply(x, r2_mod_n); }
+        UInt<N> from_montgomery(const UInt<N>& x) const { return multiply(x, UInt<N>(1)); }
+
+        // base_mont^exp in Montgomery form, fixed 4-bit windows.
+        UInt<N> pow_montgomery(const UInt<N>& base_mont, const UInt<N>& exp) const {
+            UInt<N> table[16];
+            table[0] = r_mod_n;
+            for (size_t i = 1; i < 16; ++i) table[i] = multiply(table[i - 1], base_mont);
+
+            const size_t bits = exp.bit_length();
+            UInt<N> result = r_mod_n;
+            for (size_t w = (bits + 3) / 4; w-- > 0;) {
+                if (w + 1 < (bits + 3) / 4) {
+                    for (int s = 0; s < 4; ++s) result = multiply(result, result);
+                }
+                const size_t shift = 4 * w;
+                const unsigned digit = (exp.limb[shift / 64] >> (shift % 64)) & 15;
+                if (digit) result = multiply(result, table[digit]);
+            }
+            return result;
+        }
+
+        // base^exp mod n for base < n.
+        UInt<N> pow(const UInt<N>& base, const UInt<N>& exp) const {
+            return from_montgomery(pow_montgomery(to_montgomery(base), exp));
+        }
+    };
+
+    using Montgomery128 = Montgomery<2>;
+    using Montgomery256 = Montgomery<4>;
+
+    template<size_t N>
+    UInt<N> mod_pow(const UInt<N>& base, const UInt<N>& exp, const Montgomery<N>& mont) {
+        return mont.pow(base, exp);
+    }
+
+    // x^exp mod 2^k, k <= 64N.
+    template<size_t N>
+    UInt<N> mod_pow_2k(UInt<N> x, const UInt<N>& exp, size_t k) {
+        auto truncate = [k](UInt<N>& v) {
+            for (size_t i = 0; i < N; ++i) {
+                if (64 * i >= k) v.limb[i] = 0;
+                else if (64 * (i + 1) > k) v.limb[i] &= (1ULL << (k % 64)) - 1;
+            }
+        };
+        UInt<N> result(1);
+        truncate(result);
+        truncate(x);
+        for (size_t i = exp.bit_length(); i-- > 0;) {
+            result = multiply_low(result, result);
+            if (exp.bit(i)) result = multiply_low(result, x);
+            truncate(result);
+        }
+        return result;
+    }
+
+    // Uniform in [2, n - 2] for n > 4, by rejection on n's bit length.
+    template<size_t N>
+    UInt<N> random_below(const UInt<N>& n, StreamRNG& rng) {
+        const size_t bits = n.bit_length();
+        UInt<N> limit = n;
+        limit.sub(UInt<N>(2));
+        while (true) {
+            UInt<N> x;
+            rng.fill(x.limb.data(), (bits + 63) / 64);
+            if (bits % 64) x.limb[(bits - 1) / 64] &= (1ULL << (bits % 64)) - 1;
+            if (x >= UInt<N>(2) && !(limit < x)) return x;
+        }
+    }
+
+    // Trial division by small primes, then `rounds` random bases. Above 2^64
+    // there is no known deterministic base set, so this is probabilistic
+    // with error below 4^-rounds.
+    template<size_t N>
+    bool is_prime_miller_rabin(const UInt<N>& n, size_t rounds = config::MILLER_RABIN_ROUNDS) {
+        static constexpr uint64_t SMALL_PRIMES[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+        if (n < UInt<N>(2)) return false;
+        for (uint64_t p : SMALL_PRIMES) {
+            if (n == UInt<N>(p)) return true;
+            if (n.mod_small(p) == 0) return false;
+        }
+        if (n < UInt<N>(59 * 59)) return true;
+
+        const Montgomery<N> mont(n);
+        UInt<N> n_minus_1 = n;
+        n_minus_1.sub(UInt<N>(1));
+        const UInt<N> minus_one = mont.to_montgomery(n_minus_1);
+        const size_t s = n_minus_1.trailing_zeros();
+        UInt<N> d = n_minus_1;
+        d.shift_right(s);
+
+        static thread_local StreamRNG rng;
+        for (size_t round = 0; round < rounds; ++round) {
+            UInt<N> x = mont.pow_montgomery(mont.to_montgomery(random_below(n, rng)), d);
+            if (x == mont.one() || x == minus_one) continue;
+            bool composite = true;
+            for (size_t r = 1; r < s; ++r) {
+                x = mont.multiply(x, x);
+                if (x == minus_one) {
+                    composite = false;
+                    break;
+                }
+            }
+            if (composite) return false;
+        }
+        return true;
+    }
+
+    // phi(n) = prod p^(k-1) (p - 1) over the prime factorisation of n.
+    template<size_t N>
+    UInt<N> euler_phi(const std::map<UInt<N>, int>& factors) {
+        UInt<N> phi(1);
+        for (const auto& [p, k] : factors) {
+            UInt<N> p_minus_1 = p;
+            p_minus_1.sub(UInt<N>(1));
+            phi = multiply_low(phi, p_minus_1);
+            for (int i = 1; i < k; ++i) phi = multiply_low(phi, p);
+        }
+        return phi;
+    }
+
+    template<size_t N>
+    struct WideTestResult {
+        size_t total_tests = 0;
+        size_t passed_tests = 0;
+        size_t skipped_tests = 0;
+        std::vector<std::tuple<UInt<N>, UInt<N>, UInt<N>>> counterexamples;  // (a, n, phi)
+        double avg_computation_time = 0.0;
+    };
+
+    // Checks a^phi(n) = 1 mod n for `tests` random bases, given the
+    // factorisation of n > 4. Even n is split as 2^k * m; a^phi is 1 mod n
+    // exactly when it is 1 mod m (Montgomery) and 1 mod 2^k (truncated).
+    // Throws std::overflow_error if n does not fit in N limbs and
+    // std::invalid_argument if n <= 4.
+    template<size_t N>
+    WideTestResult<N> test_euler_theorem_wide(const std::map<UInt<N>, int>& factors, size_t tests,
+                                              StreamRNG& rng, size_t max_counterexamples = 100) {
+        WideTestResult<N> result;
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        UInt<N> n(1);
+        for (const auto& [p, k] : factors) {
+            for (int i = 0; i < k; ++i) n = multiply_checked(n, p);
+        }
+        if (!(UInt<N>(4) < n)) throw std::invalid_argument("test_euler_theorem_wide: n must exceed 4");
+        const UInt<N> phi = euler_phi(factors);
+
+        UInt<N> odd = n;
+        const size_t two_power = n.trailing_zeros();
+        odd.shift_right(two_power);
+        const bool has_odd = odd != UInt<N>(1);
+        const Montgomery<N> mont(has_odd ? odd : UInt<N>(3));
+
+        for (size_t t = 0; t < tests; ++t) {
+            const UInt<N> a = random_below(n, rng);
+            if (binary_gcd(a, n) != UInt<N>(1)) {
+                result.skipped_tests++;
+                continue;
+            }
+            result.total_tests++;
+
+            bool passed = true;
+            if (has_odd) passed = mont.pow_montgomery(mont.to_montgomery(a), phi) == mont.one();
+            if (passed && two_power > 0) passed = mod_pow_2k(a, phi, two_power) == UInt<N>(1);
+
+            if (passed) {
+                result.passed_tests++;
+            } else if (result.counterexamples.size() < max_counterexamples) {
+                result.counterexamples.emplace_back(a, n, phi);
+            }
+        }
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        result.avg_computation_time = std::chrono::duration<double>(end_time - start_time).count();
+        return result;
+    }
+}
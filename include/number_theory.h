@@ -1,19 +1,20 @@
 #pragma once
 #include <cstdint>
 #include <map>
+#include <string>
 #include <vector>
 #include <tuple>
 #include <functional>
 #include "config.h"
+#include "sieve.h"
+#include "rng.h"
 
 namespace number_theory {
+    class ResultSink;
+    
     using u128 = __uint128_t;
     using i128 = __int128_t;
 
-    #ifdef __AVX2__
-    void simd_sieve_primes(std::vector<bool>& is_prime, uint64_t limit);
-    #endif
-    
     class MontgomeryModulus {
         uint64_t n, r, n_inv, r_squared;
         int bits;
@@ -24,33 +25,215 @@ namespace number_theory {
         uint64_t multiply(uint64_t a, uint64_t b) const;
         uint64_t to_montgomery(uint64_t x) const;
         uint64_t from_montgomery(uint64_t x) const;
+        uint64_t modulus() const { return n; }
+    };
+    
+    // Montgomery arithmetic for odd n with a fixed R = 2^64. n^-1 mod 2^64 is
+    // found by Newton iteration, so construction costs no extended Euclid.
+    class Montgomery64 {
+        uint64_t n, n_inv, r_mod_n, r2_mod_n;
+        
+    public:
+        explicit Montgomery64(uint64_t odd_modulus);
+        // Rebuilds a context from constants saved by inverse()/r_squared().
+        Montgomery64(uint64_t odd_modulus, uint64_t inverse, uint64_t r_squared);
+        
+        uint64_t modulus() const { return n; }
+        uint64_t one() const { return r_mod_n; }
+        uint64_t inverse() const { return n_inv; }
+        uint64_t r_squared() const { return r2_mod_n; }
+        
+        uint64_t reduce(u128 x) const {
+            uint64_t m = uint64_t(x) * n_inv;
+            uint64_t hi = uint64_t(x >> 64);
+            uint64_t mn_hi = uint64_t((u128(m) * n) >> 64);
+            return hi >= mn_hi ? hi - mn_hi : hi - mn_hi + n;
+        }
+        uint64_t multiply(uint64_t a, uint64_t b) const { return reduce(u128(a) * b); }
+        uint64_t to_montgomery(uint64_t x) const { return multiply(x % n, r2_mod_n); }
+        uint64_t from_montgomery(uint64_t x) const { return reduce(x); }
+        
+        uint64_t pow_montgomery(uint64_t base_mont, uint64_t exp) const;
+        uint64_t pow(uint64_t base, uint64_t exp) const {
+            return from_montgomery(pow_montgomery(to_montgomery(base), exp));
+        }
     };
     
+    // Any modulus n >= 1. n = 2^k * m with m odd: the odd part runs through
+    // Montgomery64, the 2^k part is wrapping 64-bit arithmetic, and the two
+    // residues are recombined by CRT.
+    class MontgomeryContext {
+        uint64_t n;
+        int twos;
+        Montgomery64 odd;
+        uint64_t two_mask, odd_inv_mod_2k;
+        
+    public:
+        explicit MontgomeryContext(uint64_t modulus);
+        MontgomeryContext(uint64_t modulus, const Montgomery64& odd_part);
+        
+        uint64_t modulus() const { return n; }
+        int two_power() const { return twos; }
+        const Montgomery64& odd_part() const { return odd; }
+        
+        uint64_t combine(uint64_t odd_residue, uint64_t two_residue) const;
+        uint64_t pow(uint64_t base, uint64_t exp) const;
+    };
+    
+    // Deterministic for every 64-bit input; no RNG or allocation.
+    bool is_prime_u64(uint64_t n);
     bool is_prime_miller_rabin(uint64_t n, size_t rounds = config::MILLER_RABIN_ROUNDS);
     uint64_t pollard_rho_factor(uint64_t n);
+    // Original Floyd-cycle implementation, kept as a benchmark reference.
+    uint64_t pollard_rho_floyd(uint64_t n);
     std::map<uint64_t, int> factorize_advanced(uint64_t n);
     uint64_t euler_phi(uint64_t n);
     uint64_t carmichael_lambda(uint64_t n);
     
+    // phi[n] for every 0 <= n <= max_n, built by a linear sieve in O(max_n).
+    std::vector<uint64_t> build_totient_table(uint64_t max_n);
+    
+    class UnitSampler;
+    
+    // Per-modulus data for the contiguous range [first, first + size()),
+    // stored as flat arrays indexed by n - first. Once filled it is only
+    // read, so any number of threads can share it without locking.
+    struct ModulusTable {
+        static constexpr size_t FACTOR_SLOTS = SpfTable::MAX_DISTINCT_PRIMES;
+        
+        uint64_t first = 0;
+        std::vector<uint64_t> phi;
+        std::vector<uint64_t> mont_inverse, mont_r_squared;
+        // Only with factors: the distinct sieving primes of n in increasing
+        // order, FACTOR_SLOTS per n. At most one prime of n is missing, the
+        // one above sqrt(n), and it is whatever remains after dividing these out.
+        std::vector<uint32_t> small_primes;
+        std::vector<uint8_t> small_prime_count;
+        
+        size_t size() const { return phi.size(); }
+        void reset(uint64_t first_n, uint64_t last_n, bool with_factors = false);
+        // Fills [from, to) of the current range; disjoint slices may be
+        // filled concurrently. sieving_primes must cover sqrt(to - 1).
+        void fill(uint64_t from, uint64_t to, const std::vector<uint64_t>& sieving_primes);
+        MontgomeryContext context(uint64_t n) const;
+        // Needs a table reset with factors; no factoring per n.
+        UnitSampler sampler(uint64_t n) const;
+    };
+    
+    ModulusTable build_modulus_table(uint64_t first_n, uint64_t last_n, bool with_factors = false);
+    
+    // Uniform random units mod n built from the factorisation of n. An index
+    // in [0, phi(n)) is split into one digit per prime-power component, each
+    // digit is mapped straight to a unit mod p^k, and CRT recombines them:
+    // one bounded draw per unit, no gcd and no rejection.
+    class UnitSampler {
+        struct Component {
+            uint64_t p, units, crt_coeff;
+        };
+        
+        uint64_t n = 1, phi_n = 1;
+        Component components[SpfTable::MAX_DISTINCT_PRIMES];
+        size_t count = 0;
+        
+        void init(const uint64_t* primes, const int* exponents, size_t num_primes);
+        
+    public:
+        // Factors n with the installed SPF table when it covers n, otherwise
+        // with factorize_advanced.
+        explicit UnitSampler(uint64_t modulus);
+        UnitSampler(uint64_t modulus, const std::map<uint64_t, int>& factors);
+        // From the distinct primes of n up to sqrt(n), increasing; what is
+        // left of n after dividing them out is 1 or prime.
+        UnitSampler(uint64_t modulus, const uint32_t* small_primes, size_t num_small);
+        
+        uint64_t modulus() const { return n; }
+        uint64_t phi() const { return phi_n; }
+        // Bijection from [0, phi(n)) onto the units mod n.
+        uint64_t unit(uint64_t index) const;
+        uint64_t sample(StreamRNG& rng) const { return unit(rng.bounded(phi_n)); }
+        void fill(StreamRNG& rng, uint64_t* out, size_t num_units) const;
+    };
+    
     struct EulerTestResult {
         size_t total_tests = 0;
         size_t passed_tests = 0;
         size_t skipped_tests = 0;
+        // Bases drawn directly as units by UnitSampler; these never reach
+        // skipped_tests.
+        size_t sampled_tests = 0;
         std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> counterexamples;
         double avg_computation_time = 0.0;
         std::map<uint64_t, size_t> modulus_distribution;
+        // Units a mod n for which a^phi(n) = 1 has been proven (exhaustive mode).
+        uint64_t verified_units = 0;
+        // Per worker thread: seconds spent testing and seconds spent waiting
+        // for or looking for work. Filled by the scheduled testers.
+        std::vector<double> thread_busy_seconds;
+        std::vector<double> thread_idle_seconds;
     };
     
-    EulerTestResult stress_test_euler_theorem(uint64_t max_n, size_t tests_per_n, size_t max_counterexamples = 100);
+    struct StressTestConfig {
+        bool use_totient_table = false;
+        size_t num_threads = 0;  // 0 = hardware concurrency
+        // Bases for modulus n come from StreamRNG::keyed(seed, n), as in the
+        // batch tester, so results do not depend on how work was stolen.
+        uint64_t seed = config::RNG_DEFAULT_SEED;
+        // Receives every counterexample, uncapped, and with record_moduli
+        // one ModulusSummary per n. The in-memory list stays capped.
+        ResultSink* sink = nullptr;
+        bool record_moduli = false;
+        // Draw bases with UnitSampler instead of rejecting non-units.
+        bool use_unit_sampler = false;
+    };
+    
+    EulerTestResult stress_test_euler_theorem(uint64_t max_n, size_t tests_per_n, size_t max_counterexamples = 100,
+                                              const StressTestConfig& config = {});
+    uint64_t mod_pow(uint64_t base, uint64_t exp, uint64_t mod);
     uint64_t mod_pow_montgomery(uint64_t base, uint64_t exp, const MontgomeryModulus& mont);
     
+    uint64_t mod_pow_montgomery(uint64_t base, uint64_t exp, const MontgomeryContext& ctx);
+    // out[i] = bases[i]^exp mod n for every i, sharing one square-and-multiply
+    // ladder across SIMD lanes (AVX-512/AVX2 when the odd part of n is below
+    // 2^32, interleaved scalar ladders otherwise). Callers that reuse n keep
+    // its MontgomeryContext, so the constants are computed once.
+    void mod_pow_montgomery_batch(const uint64_t* bases, size_t count, uint64_t exp,
+                                  const MontgomeryContext& ctx, uint64_t* out);
+    
     struct BatchTestConfig {
         uint64_t batch_size = 1000;
         size_t num_threads = 0; 
         bool use_montgomery = true;
         bool enable_caching = true;
+        bool use_totient_table = false;
+        // Bases for modulus n come from StreamRNG::keyed(seed, n), so a run
+        // is reproducible regardless of thread count or interruption.
+        uint64_t seed = config::RNG_DEFAULT_SEED;
+        // Lowest modulus tested; a shard covers [first_n, max_n].
+        uint64_t first_n = 2;
+        // When set, progress is saved to this file at window boundaries at
+        // most every checkpoint_interval seconds, and once at the end.
+        std::string checkpoint_path;
+        double checkpoint_interval = 60.0;
+        // Continue from checkpoint_path if it holds a compatible checkpoint.
+        bool resume = false;
+        // As in StressTestConfig; the sink is flushed before every checkpoint.
+        ResultSink* sink = nullptr;
+        bool record_moduli = false;
+        bool use_unit_sampler = false;
+        // Cap on result.counterexamples, shared by all threads and counting
+        // those carried over by resume. The sink still receives every one.
+        size_t max_counterexamples = 100;
     };
     
     EulerTestResult batch_test_euler_theorem(uint64_t max_n, size_t tests_per_n, 
                                            const BatchTestConfig& config = {});
+    
+    // Proves a^phi(n) = 1 for every unit a mod n, 2 <= n <= max_n. (Z/nZ)* is
+    // split into cyclic factors from the factorisation of n, the order of
+    // each factor's generator is certified, and g^phi(n) = 1 is checked for
+    // the CRT lift of every generator, which covers the whole group. Each
+    // generator check counts as one test. Factoring uses the installed SPF
+    // table, or builds one over max_n for the run (2 bytes per n).
+    EulerTestResult exhaustive_test_euler_theorem(uint64_t max_n, size_t num_threads = 0,
+                                                  size_t max_counterexamples = 100);
 }
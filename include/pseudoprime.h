@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "config.h"
+
+namespace number_theory {
+    class ResultSink;
+
+    struct PseudoprimeConfig {
+        bool carmichael = true;
+        // Fermat (b^(n-1) = 1) and Euler-Jacobi (b^((n-1)/2) = (b/n))
+        // pseudoprimes are checked for each base against every odd composite.
+        bool fermat = true;
+        bool euler = true;
+        std::vector<uint64_t> bases = {2};
+        size_t num_threads = 0;  // 0 = hardware concurrency
+        // Receives a Carmichael, FermatPseudoprime or EulerPseudoprime
+        // record for each hit, unordered across segments.
+        ResultSink* sink = nullptr;
+    };
+
+    struct PseudoprimeResult {
+        uint64_t odd_numbers = 0;
+        uint64_t carmichael = 0;
+        std::vector<uint64_t> fermat;  // per base, in config.bases order
+        std::vector<uint64_t> euler;
+        double computation_time = 0.0;
+    };
+
+    int jacobi_symbol(uint64_t a, uint64_t n);
+
+    // Enumerates pseudoprimes among the odd n in [lower, upper). Each segment
+    // is factored by sieving with the primes up to sqrt(upper), carrying
+    // Korselt's criterion (squarefree, p - 1 | n - 1) along per n, so
+    // Carmichael numbers need no exponentiation; the sieve also marks the
+    // composites that get one Montgomery64 power per base.
+    PseudoprimeResult enumerate_pseudoprimes(uint64_t lower, uint64_t upper, const PseudoprimeConfig& config = {});
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "number_theory.h"
+
+namespace number_theory {
+    // State of an interrupted batch_test_euler_theorem run: every n below
+    // next_n has been tested and its outcome is folded into partial.
+    struct Checkpoint {
+        uint64_t first_n = 2;
+        uint64_t max_n = 0;
+        uint64_t tests_per_n = 0;
+        uint64_t seed = 0;
+        uint64_t next_n = 2;
+        bool use_unit_sampler = false;
+        // ResultSink::records_written() when the checkpoint was taken.
+        uint64_t sink_records = 0;
+        EulerTestResult partial;
+    };
+
+    // Writes path + ".tmp" and renames it over path, so a crash leaves either
+    // the previous checkpoint or the new one, never a torn file.
+    bool save_checkpoint(const std::string& path, const Checkpoint& checkpoint);
+    // False if the file is missing, truncated or fails its checksum.
+    bool load_checkpoint(const std::string& path, Checkpoint& checkpoint);
+
+    // Outcome of one process's slice [first_n, max_n] of a sharded run.
+    struct ShardResult {
+        uint64_t first_n = 2;
+        uint64_t max_n = 0;
+        uint64_t tests_per_n = 0;
+        uint64_t seed = 0;
+        bool use_unit_sampler = false;
+        EulerTestResult result;
+    };
+
+    bool save_shard_result(const std::string& path, const ShardResult& shard);
+    bool load_shard_result(const std::string& path, ShardResult& shard);
+
+    // Adds the counters and counterexamples of part to total. Times are
+    // summed, so the merged time is total compute, not wall clock.
+    void merge_results(EulerTestResult& total, const EulerTestResult& part);
+
+    // Combines shards of one run into a single result over their union.
+    // Fails with a message in error if the shards disagree on tests_per_n,
+    // seed or use_unit_sampler, overlap, or leave a gap.
+    bool merge_shard_results(std::vector<ShardResult> shards, ShardResult& merged, std::string& error);
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace number_theory {
+    enum class RecordKind : uint32_t {
+        // a^phi mod n = result != 1 for a unit a; count is 1.
+        Counterexample = 1,
+        // Totals for one modulus: count bases tested, a of them passed,
+        // result of them skipped as non-units.
+        ModulusSummary = 2,
+        // Carmichael number n with count prime factors; phi is phi(n).
+        Carmichael = 3,
+        // a^phi = result = 1 mod n for composite n, phi = n - 1.
+        FermatPseudoprime = 4,
+        // a^phi = result = (a/n) mod n for composite n, phi = (n - 1) / 2.
+        EulerPseudoprime = 5,
+    };
+
+    // Fixed-size record, written to files as its raw 40 bytes.
+    struct ResultRecord {
+        RecordKind kind;
+        uint32_t count;
+        uint64_t n;
+        uint64_t a;
+        uint64_t phi;
+        uint64_t result;
+    };
+    static_assert(sizeof(ResultRecord) == 40, "ResultRecord is a 40-byte on-disk format");
+
+    // Destination for tester output. write() receives whole blocks from the
+    // per-thread writers and may be called from several threads at once.
+    class ResultSink {
+    public:
+        virtual ~ResultSink() = default;
+        virtual void write(const ResultRecord* records, size_t count) = 0;
+        virtual void flush() {}
+        // Records accepted so far. The batch tester stores this in each
+        // checkpoint and rewinds to it on resume, so a window finished after
+        // the checkpoint is not written twice. Sinks that cannot take records
+        // back return false.
+        virtual uint64_t records_written() const { return 0; }
+        virtual bool rewind(uint64_t /*records*/) { return false; }
+    };
+
+    // Appends records to a binary file behind an 8-byte magic. With append,
+    // an existing file is continued (e.g. after --resume).
+    class FileResultSink : public ResultSink {
+        std::FILE* file = nullptr;
+        std::string path;
+        uint64_t written = 0;
+        mutable std::mutex mtx;
+
+    public:
+        explicit FileResultSink(const std::string& path, bool append = false);
+        ~FileResultSink() override;
+
+        FileResultSink(const FileResultSink&) = delete;
+        FileResultSink& operator=(const FileResultSink&) = delete;
+
+        bool is_open() const { return file != nullptr; }
+        void write(const ResultRecord* records, size_t count) override;
+        void flush() override;
+        uint64_t records_written() const override;
+        // Truncates the file to its first `records` records.
+        bool rewind(uint64_t records) override;
+    };
+
+    // Hands each block to a callback, one block at a time.
+    class CallbackResultSink : public ResultSink {
+        std::function<void(const ResultRecord*, size_t)> callback;
+        std::mutex mtx;
+
+    public:
+        explicit CallbackResultSink(std::function<void(const ResultRecord*, size_t)> fn) : callback(std::move(fn)) {}
+        void write(const ResultRecord* records, size_t count) override;
+    };
+
+    // Per-thread buffer in front of a shared sink, so threads touch the sink
+    // once per BUFFER_RECORDS records. Flushes on destruction.
+    class ResultWriter {
+        ResultSink* sink;
+        std::vector<ResultRecord> buffer;
+
+    public:
+        static constexpr size_t BUFFER_RECORDS = 1024;
+
+        explicit ResultWriter(ResultSink* target) : sink(target) {
+            if (sink) buffer.reserve(BUFFER_RECORDS);
+        }
+        ~ResultWriter() { flush(); }
+
+        ResultWriter(const ResultWriter&) = delete;
+        ResultWriter& operator=(const ResultWriter&) = delete;
+
+        bool active() const { return sink != nullptr; }
+        void add(const ResultRecord& record) {
+            buffer.push_back(record);
+            if (buffer.size() == BUFFER_RECORDS) flush();
+        }
+        void flush() {
+            if (sink && !buffer.empty()) sink->write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    };
+
+    // Reads back a file written by FileResultSink.
+    class ResultReader {
+        std::FILE* file = nullptr;
+
+    public:
+        explicit ResultReader(const std::string& path);
+        ~ResultReader();
+
+        ResultReader(const ResultReader&) = delete;
+        ResultReader& operator=(const ResultReader&) = delete;
+
+        bool is_open() const { return file != nullptr; }
+        bool next(ResultRecord& record);
+        // Up to max_count records into out; returns how many were read.
+        size_t read(ResultRecord* out, size_t max_count);
+    };
+}
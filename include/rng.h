@@ -1,5 +1,8 @@
 #pragma once
 #include <array>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
 #include <chrono>
 #include <mutex>
 #include <type_traits>
@@ -29,3 +32,84 @@ private:
         return (x << k) | (x >> (64 - k));
     }
 };
+
+// Lock-free xoshiro256** generator meant to be owned by a single thread.
+// It runs LANES independent states and draws from them round-robin, so
+// fill() can advance all lanes together in one vectorizable loop and still
+// return exactly the values repeated next() calls would. jump() advances
+// every lane by 2^128 draws and long_jump() by 2^192, so stream(seed, i)
+// hands each thread a sequence that never overlaps another thread's.
+class StreamRNG {
+public:
+    static constexpr size_t LANES = 4;
+
+    explicit StreamRNG(uint64_t seed = config::RNG_DEFAULT_SEED);
+
+    // The index-th non-overlapping stream of seed (index jump() calls).
+    static StreamRNG stream(uint64_t seed, uint64_t index);
+    // Stream for one work item, e.g. one modulus, so the draws depend only
+    // on (seed, key) and not on which thread handles the item. Cheap to
+    // construct; streams are independent in practice, not jump-separated.
+    static StreamRNG keyed(uint64_t seed, uint64_t key);
+
+    uint64_t next() {
+        const size_t i = lane;
+        lane = (lane + 1) & (LANES - 1);
+        const uint64_t result = rotl(s1[i] * 5, 7) * 9;
+        const uint64_t t = s1[i] << 17;
+
+        s2[i] ^= s0[i];
+        s3[i] ^= s1[i];
+        s1[i] ^= s2[i];
+        s0[i] ^= s3[i];
+
+        s2[i] ^= t;
+        s3[i] = rotl(s3[i], 45);
+
+        return result;
+    }
+
+    void jump();
+    void long_jump();
+
+    // Uniform in [0, range), range > 0. Lemire's multiply-shift with
+    // rejection, so no value is favoured.
+    uint64_t bounded(uint64_t range) {
+        __uint128_t m = static_cast<__uint128_t>(next()) * range;
+        uint64_t low = static_cast<uint64_t>(m);
+        if (low < range) {
+            const uint64_t threshold = -range % range;
+            while (low < threshold) {
+                m = static_cast<__uint128_t>(next()) * range;
+                low = static_cast<uint64_t>(m);
+            }
+        }
+        return static_cast<uint64_t>(m >> 64);
+    }
+
+    template<typename T>
+    T uniform(T min_val, T max_val) {
+        if constexpr (std::is_integral_v<T>) {
+            const uint64_t span = static_cast<uint64_t>(max_val) - static_cast<uint64_t>(min_val);
+            if (span == std::numeric_limits<uint64_t>::max()) return static_cast<T>(next());
+            return static_cast<T>(static_cast<uint64_t>(min_val) + bounded(span + 1));
+        } else {
+            return min_val + (max_val - min_val) * (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+    }
+
+    // out[0..count) = the next count raw draws.
+    void fill(uint64_t* out, size_t count);
+    // out[0..count) uniform in [min_val, max_val], unbiased.
+    void fill(uint64_t* out, size_t count, uint64_t min_val, uint64_t max_val);
+
+private:
+    alignas(32) uint64_t s0[LANES], s1[LANES], s2[LANES], s3[LANES];
+    size_t lane = 0;
+
+    void apply_jump(const uint64_t (&polynomial)[4]);
+
+    static constexpr uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace parallel {
+    struct WorkerStats {
+        double busy_seconds = 0.0;
+        double idle_seconds = 0.0;
+        size_t chunks = 0;
+        size_t steals = 0;
+    };
+
+    // Splits [begin, end) evenly between workers. A worker takes guided
+    // chunks (a fraction of what it still owns) from the front of its own
+    // range. Once that range is empty it steals the back half of the
+    // fullest remaining range.
+    class WorkStealingScheduler {
+        struct alignas(64) WorkerRange {
+            std::mutex mtx;
+            uint64_t begin = 0, end = 0;
+        };
+
+        std::unique_ptr<WorkerRange[]> ranges;
+        size_t num_workers;
+        uint64_t min_chunk;
+
+        bool steal(size_t thief);
+
+    public:
+        WorkStealingScheduler(uint64_t begin, uint64_t end, size_t workers, uint64_t min_chunk = 1);
+
+        size_t workers() const { return num_workers; }
+        bool next_chunk(size_t worker, uint64_t& chunk_begin, uint64_t& chunk_end, bool& stolen);
+
+        // Runs fn(worker, chunk_begin, chunk_end) on one thread per worker
+        // until the whole range is consumed.
+        std::vector<WorkerStats> run(const std::function<void(size_t, uint64_t, uint64_t)>& fn);
+    };
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <memory>
+#include "config.h"
+
+namespace number_theory {
+    constexpr uint8_t WHEEL30_RESIDUES[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+
+    // Wheel-30 bit-packed primality map over [lower, upper): one byte per 30
+    // integers, bit j of a byte marks the residue WHEEL30_RESIDUES[j].
+    class PrimeBitset {
+        uint64_t low = 0, high = 0;
+        std::vector<uint8_t> bytes;
+
+        friend class SegmentedSieve;
+
+    public:
+        PrimeBitset() = default;
+        PrimeBitset(uint64_t lower, uint64_t upper);
+
+        bool test(uint64_t n) const;
+        uint64_t count() const;
+        uint64_t lower() const { return low; }
+        uint64_t upper() const { return high; }
+        const std::vector<uint8_t>& data() const { return bytes; }
+    };
+
+    // Segmented Sieve of Eratosthenes on a wheel-30 layout. Each segment is
+    // sized for L2, starts from a precomputed pattern with the multiples of
+    // 7..31 already removed, and segments are distributed across threads.
+    class SegmentedSieve {
+        size_t num_threads;
+
+    public:
+        static constexpr size_t SEGMENT_BYTES = 256 * 1024;
+
+        explicit SegmentedSieve(size_t threads = 0);
+
+        PrimeBitset sieve_range(uint64_t lower, uint64_t upper) const;
+        uint64_t count_primes(uint64_t lower, uint64_t upper) const;
+        std::vector<uint64_t> primes(uint64_t lower, uint64_t upper) const;
+        void for_each_prime(uint64_t lower, uint64_t upper, const std::function<void(uint64_t)>& fn) const;
+    };
+
+    // Walks the primes of [lower, upper) in increasing order, holding a
+    // single segment in memory at a time.
+    class PrimeIterator {
+        struct State;
+        std::unique_ptr<State> state;
+
+    public:
+        PrimeIterator(uint64_t lower, uint64_t upper);
+        ~PrimeIterator();
+
+        PrimeIterator(const PrimeIterator&) = delete;
+        PrimeIterator& operator=(const PrimeIterator&) = delete;
+
+        bool next(uint64_t& prime);
+    };
+
+    // Smallest prime factor of every n < bound, for factoring by repeated
+    // lookup. Only odd n are stored (even n shifts out its 2s first) and
+    // primes are stored as 0, so 32 bits per entry cover any bound. Built
+    // in cache-sized segments spread across threads.
+    class SpfTable {
+        uint64_t bound = 0;
+        std::vector<uint32_t> odd_spf;
+
+    public:
+        static constexpr size_t SEGMENT_ENTRIES = 32 * 1024;
+        // The product of the first 16 primes exceeds 2^64.
+        static constexpr size_t MAX_DISTINCT_PRIMES = 15;
+
+        SpfTable() = default;
+        explicit SpfTable(uint64_t bound, size_t threads = 0);
+
+        uint64_t limit() const { return bound; }
+        bool covers(uint64_t n) const { return n < bound; }
+        // n >= 2, covers(n).
+        uint64_t smallest_factor(uint64_t n) const;
+        // Distinct primes of n (increasing) and their exponents; returns
+        // how many were written. n >= 1, covers(n).
+        size_t factor(uint64_t n, uint64_t* primes, int* exponents) const;
+    };
+
+    // Process-wide table used by factorize_advanced, euler_phi and
+    // carmichael_lambda for every n it covers. Install before starting
+    // threads that factor; bound 0 removes it.
+    void install_spf_table(uint64_t bound, size_t threads = 0);
+    const SpfTable* installed_spf_table();
+
+    void simd_sieve_primes(std::vector<bool>& is_prime, uint64_t limit);
+}
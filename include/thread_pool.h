@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+    // Persistent helper threads shared by every parallel loop in the
+    // library. run() hands out worker slots 1..workers-1 to idle helpers and
+    // runs slot 0 on the calling thread; helpers are only created when no
+    // idle one is left, so repeated calls pay no thread startup. All slots of
+    // one run() are live at the same time, which barrier-based callers rely
+    // on, and nested run() calls are safe.
+    class ThreadPool {
+        struct Job {
+            const std::function<void(size_t)>* fn;
+            size_t next_slot, slots;
+            size_t remaining;
+            std::mutex mtx;
+            std::condition_variable done;
+        };
+
+        std::mutex mtx;
+        std::condition_variable work_cv;
+        std::deque<Job*> pending;
+        std::vector<std::thread> helpers;
+        size_t idle = 0, unclaimed = 0;
+        bool stopping = false;
+        bool pin = false;
+
+        void helper_loop(size_t index);
+
+    public:
+        ThreadPool() = default;
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Pins each helper to one CPU, filling one NUMA node before the
+        // next. Applies to helpers created afterwards. Linux only.
+        void set_pinning(bool enabled);
+        size_t helper_count();
+
+        // Calls fn(worker) for every worker in [0, workers) concurrently
+        // and returns when all have finished.
+        void run(size_t workers, const std::function<void(size_t)>& fn);
+    };
+
+    ThreadPool& global_pool();
+
+    // Worker count for a requested thread count: 0 means one per hardware
+    // thread.
+    size_t resolve_workers(size_t requested);
+
+    // Splits [begin, end) into chunks of `grain` and calls fn(chunk_begin,
+    // chunk_end) for each on up to `threads` workers, dynamically balanced.
+    template<typename Fn>
+    void parallel_for(uint64_t begin, uint64_t end, uint64_t grain, Fn fn, size_t threads = 0) {
+        if (end <= begin) return;
+        grain = std::max<uint64_t>(grain, 1);
+        const uint64_t chunks = (end - begin + grain - 1) / grain;
+        const size_t workers = static_cast<size_t>(std::min<uint64_t>(resolve_workers(threads), chunks));
+        if (workers <= 1) {
+            fn(begin, end);
+            return;
+        }
+        std::atomic<uint64_t> next{0};
+        global_pool().run(workers, [&](size_t) {
+            for (uint64_t c; (c = next.fetch_add(1)) < chunks;) {
+                const uint64_t chunk_begin = begin + c * grain;
+                fn(chunk_begin, std::min(end, chunk_begin + grain));
+            }
+        });
+    }
+
+    // map(chunk_begin, chunk_end) -> T per chunk of `grain`, folded with
+    // combine in chunk order. The chunking depends only on the range and
+    // grain, so the result is the same for any thread count, including for
+    // floating point. Chunks run in waves of REDUCE_WAVE and each wave is
+    // folded before the next starts, so at most REDUCE_WAVE partials are
+    // alive however long the range is.
+    constexpr uint64_t REDUCE_WAVE = 1024;
+
+    template<typename T, typename Map, typename Combine>
+    T parallel_reduce(uint64_t begin, uint64_t end, uint64_t grain, T identity, Map map, Combine combine,
+                      size_t threads = 0) {
+        if (end <= begin) return identity;
+        grain = std::max<uint64_t>(grain, 1);
+        const uint64_t chunks = (end - begin + grain - 1) / grain;
+        T result = identity;
+        std::vector<T> partial;
+        for (uint64_t wave = 0; wave < chunks; wave += REDUCE_WAVE) {
+            const uint64_t wave_end = std::min(chunks, wave + REDUCE_WAVE);
+            partial.assign(wave_end - wave, identity);
+            parallel_for(wave, wave_end, 1, [&](uint64_t first, uint64_t last) {
+                for (uint64_t c = first; c < last; ++c) {
+                    const uint64_t chunk_begin = begin + c * grain;
+                    partial[c - wave] = map(chunk_begin, std::min(end, chunk_begin + grain));
+                }
+            }, threads);
+            for (auto& value : partial) result = combine(result, value);
+        }
+        return result;
+    }
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include "complex_analysis.h"
 
 #ifndef M_PI
 #define M_PI 3.141592653589793238462643383279502884L
@@ -21,7 +22,8 @@ struct MethodResult {
 
 struct ComparisonResult {
     std::vector<MethodResult> methods;
-    std::map<std::string, std::vector<long double>> error_distribution;
+    // Absolute-error statistics per method name (batch_comparison only).
+    std::map<std::string, complex_analysis::StreamingErrorStats> error_stats;
     size_t total_samples;
     long double reference_precision;
 };
@@ -54,6 +54,12 @@ namespace visualization {
         void renderRiemannSurface(const std::function<complex_analysis::Complex(complex_analysis::Complex)>& function, 
                                 double xMin, double xMax, double yMin, double yMax, int resolution = 100);
         
+        // renderRiemannSurface from precomputed samples: values[j * resolution + i]
+        // is f(x_i + i y_j) with x_i, y_j evenly spaced over the closed
+        // ranges, the layout riemann_zeta_grid writes.
+        void renderComplexGrid(const std::vector<complex_analysis::Complex>& values,
+                               double xMin, double xMax, double yMin, double yMax, int resolution);
+        
         void renderEulerCharacteristic(const topology::TopologicalMesh& mesh);
         
         void renderManifold(const std::vector<topology::Vector3>& points, 
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include "complex_analysis.h"
+
+namespace complex_analysis {
+    // Critical-line points with |t| at or above this go through
+    // Riemann-Siegel (about 1e-13 absolute error at 1e4, falling as t
+    // grows); everything else through Euler-Maclaurin.
+    constexpr Real ZETA_RIEMANN_SIEGEL_MIN_T = 1e4L;
+
+    // Riemann zeta for any s, to a few ulps of double precision. Re s >= 0
+    // uses Euler-Maclaurin with max(18, 0.3 (|s| + 60)) terms; Re s < 0 uses
+    // the functional equation zeta(s) = chi(s) zeta(1 - s), except within
+    // 0.01 of the origin, which stays with Euler-Maclaurin. s = 1 gives an
+    // infinite real part.
+    Complex riemann_zeta(Complex s);
+
+    // Hardy's Z(t) = e^(i theta(t)) zeta(1/2 + i t), which is real, and the
+    // Riemann-Siegel theta function. riemann_siegel_z uses the
+    // Riemann-Siegel formula with the C0..C4 corrections, so it needs t well
+    // above 100; its cost grows as sqrt(t).
+    Real riemann_siegel_theta(Real t);
+    Real riemann_siegel_z(Real t);
+
+    // out[j] = zeta(s0 + j step) for j in [0, count). Consecutive points
+    // differ by n^-step in every term n^-s, so the Euler-Maclaurin power
+    // sums are shared along the line: one complex multiply per term and
+    // point instead of a pow.
+    void riemann_zeta_line(Complex s0, Complex step, size_t count, Complex* out);
+
+    // out[row * width + col] = zeta(x + i y) with x running evenly over
+    // [x_min, x_max] across a row and y over [y_min, y_max] down the rows.
+    // Each row is one riemann_zeta_line; rows run on the thread pool
+    // (num_threads = 0: all cores).
+    void riemann_zeta_grid(Real x_min, Real x_max, Real y_min, Real y_max, size_t width, size_t height,
+                           Complex* out, size_t num_threads = 0);
+}
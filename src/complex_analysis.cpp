@@ -1,7 +1,12 @@
 #include "complex_analysis.h"
 #include "rng.h"
+#include "thread_pool.h"
+#include <algorithm>
 #include <cmath>
 #include <chrono>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -16,7 +21,170 @@ void KahanSum::add(Real value) {
     sum = t;
 }
 
-Complex exp_taylor_adaptive(Complex z, Real tolerance) {
+void StreamingErrorStats::add(Real value) {
+    if (n == 0) {
+        min_value = max_value = value;
+    } else {
+        min_value = std::min(min_value, value);
+        max_value = std::max(max_value, value);
+    }
+    ++n;
+    const Real delta = value - mean_value;
+    mean_value += delta / static_cast<Real>(n);
+    m2 += delta * (value - mean_value);
+    
+    size_t bucket = 0;
+    if (value > 0) {
+        int exponent;
+        const Real fraction = std::frexp(value, &exponent);  // value = fraction * 2^exponent, fraction in [0.5, 1)
+        --exponent;
+        if (exponent >= MAX_EXPONENT) {
+            bucket = BUCKETS - 1;
+        } else if (exponent >= MIN_EXPONENT) {
+            const int sub = std::min(SUB_BUCKETS - 1, static_cast<int>((2 * fraction - 1) * SUB_BUCKETS));
+            bucket = 1 + static_cast<size_t>(exponent - MIN_EXPONENT) * SUB_BUCKETS + sub;
+        }
+    }
+    histogram[bucket]++;
+}
+
+void StreamingErrorStats::merge(const StreamingErrorStats& other) {
+    if (other.n == 0) return;
+    if (n == 0) {
+        *this = other;
+        return;
+    }
+    const uint64_t total = n + other.n;
+    const Real delta = other.mean_value - mean_value;
+    mean_value += delta * static_cast<Real>(other.n) / static_cast<Real>(total);
+    m2 += other.m2 + delta * delta * static_cast<Real>(n) * static_cast<Real>(other.n) / static_cast<Real>(total);
+    n = total;
+    min_value = std::min(min_value, other.min_value);
+    max_value = std::max(max_value, other.max_value);
+    for (size_t i = 0; i < BUCKETS; i++) histogram[i] += other.histogram[i];
+}
+
+Real StreamingErrorStats::std_deviation() const {
+    return std::sqrt(variance());
+}
+
+Real StreamingErrorStats::bucket_lower_bound(size_t index) {
+    if (index == 0) return 0.0L;
+    if (index >= BUCKETS - 1) return std::ldexp(1.0L, MAX_EXPONENT);
+    const int exponent = MIN_EXPONENT + static_cast<int>((index - 1) / SUB_BUCKETS);
+    const int sub = static_cast<int>((index - 1) % SUB_BUCKETS);
+    return std::ldexp(1.0L + static_cast<Real>(sub) / SUB_BUCKETS, exponent);
+}
+
+Real StreamingErrorStats::quantile(double q) const {
+    if (n == 0) return 0.0L;
+    const uint64_t target = static_cast<uint64_t>(std::ceil(q * static_cast<double>(n)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= target && seen > 0) {
+            const Real upper = i + 1 < BUCKETS ? bucket_lower_bound(i + 1) : max_value;
+            return std::max(min_value, std::min(max_value, upper));
+        }
+    }
+    return max_value;
+}
+
+namespace {
+
+// Bits of 2/pi after the binary point, most significant first: word i
+// holds bits 64i + 1 .. 64i + 64. 16640 bits cover the reduction of any
+// finite long double. Generated offline from Machin's formula.
+constexpr uint64_t TWO_OVER_PI_BITS[] = {
+    0xA2F9836E4E441529ULL, 0xFC2757D1F534DDC0ULL, 0xDB6295993C439041ULL, 0xFE5163ABDEBBC561ULL,
+    0xB7246E3A424DD2E0ULL, 0x06492EEA09D1921CULL, 0xFE1DEB1CB129A73EULL, 0xE88235F52EBB4484ULL,
+    0xE99C7026B45F7E41ULL, 0x3991D639835339F4ULL, 0x9C845F8BBDF9283BULL, 0x1FF897FFDE05980FULL,
+    0xEF2F118B5A0A6D1FULL, 0x6D367ECF27CB09B7ULL, 0x4F463F669E5FEA2DULL, 0x7527BAC7EBE5F17BULL,
+    0x3D0739F78A5292EAULL, 0x6BFB5FB11F8D5D08ULL, 0x56033046FC7B6BABULL, 0xF0CFBC209AF4361DULL,
+    0xA9E391615EE61B08ULL, 0x6599855F14A06840ULL, 0x8DFFD8804D732731ULL, 0x06061556CA73A8C9ULL,
+    0x60E27BC08C6B47C4ULL, 0x19C367CDDCE8092AULL, 0x8359C4768B961CA6ULL, 0xDDAF44D15719053EULL,
+    0xA5FF07053F7E33E8ULL, 0x32C2DE4F98327DBBULL, 0xC33D26EF6B1E5EF8ULL, 0x9F3A1F35CAF27F1DULL,
+    0x87F121907C7C246AULL, 0xFA6ED5772D30433BULL, 0x15C614B59D19C3C2ULL, 0xC4AD414D2C5D000CULL,
+    0x467D862D71E39AC6ULL, 0x9B0062337CD2B497ULL, 0xA7B4D55537F63ED7ULL, 0x1810A3FC764D2A9DULL,
+    0x64ABD770F87C6357ULL, 0xB07AE715175649C0ULL, 0xD9D63B3884A7CB23ULL, 0x24778AD623545AB9ULL,
+    0x1F001B0AF1DFCE19ULL, 0xFF319F6A1E666157ULL, 0x9947FBACD87F7EB7ULL, 0x652289E83260BFE6ULL,
+    0xCDC4EF09366CD43FULL, 0x5DD7DE16DE3B5892ULL, 0x9BDE2822D2E88628ULL, 0x4D58E232CAC616E3ULL,
+    0x08CB7DE050C017A7ULL, 0x1DF35BE01834132EULL, 0x6212830148835B8EULL, 0xF57FB0ADF2E91E43ULL,
+    0x4A48D36710D8DDAAULL, 0x425FAECE616AA428ULL, 0x0AB499D3F2A6067FULL, 0x775C83C2A3883C61ULL,
+    0x78738A5A8CAFBDD7ULL, 0x6F63A62DCBBFF4EFULL, 0x818D67C12645CA55ULL, 0x36D9CAD2A8288D61ULL,
+    0xC277C9121426049BULL, 0x4612C459C444C5C8ULL, 0x91B24DF31700AD43ULL, 0xD4E5492910D5FDFCULL,
+    0xBE00CC941EEECE70ULL, 0xF53E1380F1ECC3E7ULL, 0xB328F8C79405933EULL, 0x71C1B3092EF3450BULL,
+    0x9C12887B20AB9FB5ULL, 0x2EC292472F327B6DULL, 0x550C90A7721FE76BULL, 0x96CB314A1679E279ULL,
+    0x4189DFF49794E884ULL, 0xE6E29731996BED88ULL, 0x365F5F0EFDBBB49AULL, 0x486CA46742727132ULL,
+    0x5D8DB8159F09E5BCULL, 0x25318D3974F71C05ULL, 0x30010C0D68084B58ULL, 0xEE2C90AA4702E774ULL,
+    0x24D6BDA67DF77248ULL, 0x6EEF169FA6948EF6ULL, 0x91B45153D1F20ACFULL, 0x3398207E4BF56863ULL,
+    0xB25F3EDD035D407FULL, 0x8985295255C06437ULL, 0x10D86D324832754CULL, 0x5BD4714E6E5445C1ULL,
+    0x090B69F52AD56614ULL, 0x9D072750045DDB3BULL, 0xB4C576EA17F9877DULL, 0x6B49BA271D296996ULL,
+    0xACCCC65414AD6AE2ULL, 0x9089D98850722CBEULL, 0xA4049407777030F3ULL, 0x27FC00A871EA49C2ULL,
+    0x663DE06483DD9797ULL, 0x3FA3FD94438C860DULL, 0xDE41319D39928C70ULL, 0xDDE7B7173BDF082BULL,
+    0x3715A0805C93805AULL, 0x921110D8E80FAF80ULL, 0x6C4BFFDB0F903876ULL, 0x185915A562BBCB61ULL,
+    0xB989C7BD401004F2ULL, 0xD2277549F6B6EBBBULL, 0x22DBAA140A2F2689ULL, 0x768364333B091A94ULL,
+    0x0EAA3A51C2A31DAEULL, 0xEDAF12265C4DC26DULL, 0x9C7A2D9756C0833FULL, 0x03F6F0098C402B99ULL,
+    0x316D07B43915200CULL, 0x5BC3D8C492F54BADULL, 0xC6A5CA4ECD37A736ULL, 0xA9E69492AB6842DDULL,
+    0xDE6319EF8C76528BULL, 0x6837DBFCABA1AE31ULL, 0x15DFA1AE00DAFB0CULL, 0x664D64B705ED3065ULL,
+    0x29BF56573AFF47B9ULL, 0xF96AF3BE75DF9328ULL, 0x3080ABF68C6615CBULL, 0x040622FA1DE4D9A4ULL,
+    0xB33D8F1B5709CD36ULL, 0xE9424EA4BE13B523ULL, 0x331AAAF0A8654FA5ULL, 0xC1D20F3F0BCD785BULL,
+    0x76F923048B7B7217ULL, 0x8953A6C6E26E6F00ULL, 0xEBEF584A9BB7DAC4ULL, 0xBA66AACFCF761D02ULL,
+    0xD12DF1B1C1998C77ULL, 0xADC3DA4886A05DF7ULL, 0xF480C62FF0AC9AECULL, 0xDDBC5C3F6DDED01FULL,
+    0xC790B6DB2A3A25A3ULL, 0x9AAF009353AD0457ULL, 0xB6B42D297E804BA7ULL, 0x07DA0EAA76A1597BULL,
+    0x2A12162DB7DCFDE5ULL, 0xFAFEDB89FDBE896CULL, 0x76E4FCA90670803EULL, 0x156E85FF87FD073EULL,
+    0x2833676186182AEAULL, 0xBD4DAFE7B36E6D8FULL, 0x3967955BBF3148D7ULL, 0x8416DF30432DC735ULL,
+    0x6125CE70C9B8CB30ULL, 0xFD6CBFA200A4E46CULL, 0x05A0DD5A476F21D2ULL, 0x1262845CB9496170ULL,
+    0xE0566B0152993755ULL, 0x50B7D51EC4F1335FULL, 0x6E13E4305DA92E85ULL, 0xC3B21D3632A1A4B7ULL,
+    0x08D4B1EA21F716E4ULL, 0x698F77FF2780030CULL, 0x2D408DA0CD4F99A5ULL, 0x20D3A2B30A5D2F42ULL,
+    0xF9B4CBDA11D0BE7DULL, 0xC1DB9BBD17AB81A2ULL, 0xCA5C6A0817552E55ULL, 0x0027F0147F8607E1ULL,
+    0x640B148D4196DEBEULL, 0x872AFDDAB6256B34ULL, 0x897BFEF3059EBFB9ULL, 0x4F6A68A82A4A5AC4ULL,
+    0x4FBCF82D985AD795ULL, 0xC7F48D4D0DA63A20ULL, 0x5F57A4B13F149538ULL, 0x800120CC86DD71B6ULL,
+    0xDEC9F560BF11654DULL, 0x6B0701ACB08CD0C0ULL, 0xB24855510EFB1EC3ULL, 0x72953B06A33540C0ULL,
+    0x7BDC06CC45E0FA29ULL, 0x4EC8CAD641F3E8DEULL, 0x647CD8649B31BED9ULL, 0xC397A4D45877C5E3ULL,
+    0x6913DAF03C3ABA46ULL, 0x18465F7555F5BDD2ULL, 0xC6926E5D2EACED44ULL, 0x0E423E1C87C461E9ULL,
+    0xFD29F3D6E7CA7C22ULL, 0x35916FC5E0088DD7ULL, 0xFFE26A6EC6FDB0C1ULL, 0x0893745D7CB2AD6BULL,
+    0x9D6ECD7B723E6A11ULL, 0xC6A9CFF7DF7329BAULL, 0xC9B55100B70DB2E2ULL, 0x24BA74607DE58AD8ULL,
+    0x742C150D0C188194ULL, 0x667E162901767A9FULL, 0xBEFDFDEF4556367EULL, 0xD913D9ECB9BA8BFCULL,
+    0x97C427A831C36EF1ULL, 0x36C59456A8D8B5A8ULL, 0xB40ECCCF2D891234ULL, 0x576F89562CE3CE99ULL,
+    0xB920D6AA5E6B9C2AULL, 0x3ECC5F114A0BFDFBULL, 0xF4E16D3B8E2C86E2ULL, 0x84D4E9A9B4FCD1EEULL,
+    0xEFC9352E61392F44ULL, 0x2138C8D91B0AFC81ULL, 0x6A4AFBD81C2F84B4ULL, 0x538C994ECC2254DCULL,
+    0x552AD6C6C096190BULL, 0xB8701A649569605AULL, 0x26EE523F0F117F11ULL, 0xB5F4F5CBFC2DBC34ULL,
+    0xEEBC34CC5DE8605EULL, 0xDD9B8E67EF3392B8ULL, 0x17C99B5861BC57E1ULL, 0xC68351103ED84871ULL,
+    0xDDDD1C2DA118AF46ULL, 0x2C21D7F359987AD9ULL, 0xC0549EFA864FFC06ULL, 0x56AE79E536228922ULL,
+    0xAD38DC9367AAE855ULL, 0x3826829BE7CAA40DULL, 0x51B133990ED7A948ULL, 0x0569F0B265A7887FULL,
+    0x974C8836D1F9B392ULL, 0x214A827B21CF98DCULL, 0x9F405547DC3A74E1ULL, 0x42EB67DF9DFE5FD4ULL,
+    0x5EA4677B7AACBAA2ULL, 0xF65523882B55BA41ULL, 0x086E59862A218347ULL, 0x39E6E389D49EE540ULL,
+    0xFB49E956FFCA0F1CULL, 0x8A59C52BFA94C5C1ULL, 0xD3CFC50FAE5ADB86ULL, 0xC5476243853B8621ULL,
+    0x94792C8761107B4CULL, 0x2A1A2C8012BF4390ULL, 0x2688893C78E4C4A8ULL, 0x7BDBE5C23AC4EAF4ULL,
+    0x268A67F7BF920D2BULL, 0xA365B1933D0B7CBDULL, 0xDC51A463DD27DDE1ULL, 0x6919949A9529A828ULL,
+    0xCE68B4ED09209F44ULL, 0xCA984E638270237CULL, 0x7E32B90F8EF5A7E7ULL, 0x561408F1212A9DB5ULL,
+    0x4D7E6F5119A5ABF9ULL, 0xB5D6DF8261DD9602ULL, 0x36169F3AC4A1A283ULL, 0x6DED727A8D39A9B8ULL,
+    0x825C326B5B2746EDULL, 0x34007700D255F4FCULL, 0x4D59018071E0E13FULL, 0x89B295F364A8F1AEULL,
+};
+constexpr size_t TWO_OVER_PI_WORDS = sizeof(TWO_OVER_PI_BITS) / sizeof(TWO_OVER_PI_BITS[0]);
+
+// floor(pi/2 * 2^127).
+constexpr unsigned __int128 PIO2_FIXED = (static_cast<unsigned __int128>(0xC90FDAA22168C234ULL) << 64) | 0xC4C6628B80DC1CD1ULL;
+constexpr Real PI_OVER_4 = 0.785398163397448309615660845819875721L;
+
+// Bits j .. j + 63 of 2/pi (j >= 1), zero past the end of the table.
+uint64_t two_over_pi_bits(uint64_t j) {
+    const uint64_t word = (j - 1) / 64, offset = (j - 1) % 64;
+    const uint64_t hi = word < TWO_OVER_PI_WORDS ? TWO_OVER_PI_BITS[word] : 0;
+    const uint64_t lo = word + 1 < TWO_OVER_PI_WORDS ? TWO_OVER_PI_BITS[word + 1] : 0;
+    return offset ? (hi << offset) | (lo >> (64 - offset)) : hi;
+}
+
+// Bits pos .. pos + 63 of a little-endian multiword integer.
+uint64_t extract_bits(const uint64_t* words, size_t count, uint64_t pos) {
+    const uint64_t word = pos / 64, offset = pos % 64;
+    const uint64_t lo = word < count ? words[word] : 0;
+    const uint64_t hi = word + 1 < count ? words[word + 1] : 0;
+    return offset ? (lo >> offset) | (hi << (64 - offset)) : lo;
+}
+
+Complex exp_taylor_unreduced(Complex z, Real tolerance) {
     KahanSum real_sum, imag_sum;
     real_sum.add(1.0L);
     
@@ -34,7 +202,7 @@ Complex exp_taylor_adaptive(Complex z, Real tolerance) {
             if (std::abs(z) > 1) {
                 int reduction_factor = static_cast<int>(std::ceil(std::log2(std::abs(z))));
                 Complex z_reduced = z / static_cast<Real>(1 << reduction_factor);
-                Complex result = exp_taylor_adaptive(z_reduced, tolerance);
+                Complex result = exp_taylor_unreduced(z_reduced, tolerance);
                 
                 for (int i = 0; i < reduction_factor; i++) {
                     result *= result;
@@ -49,55 +217,224 @@ Complex exp_taylor_adaptive(Complex z, Real tolerance) {
     return Complex(real_sum.get(), imag_sum.get());
 }
 
-ComplexBenchmark benchmark_euler_formula(size_t num_samples) {
-    ComplexBenchmark benchmark;
-    benchmark.samples = num_samples;
-    benchmark.error_histogram.resize(100, 0);
-    
-    SecureRNG rng;
-    std::vector<Real> errors;
-    errors.reserve(num_samples);
+}
+
+Real reduce_pi_over_2(Real theta, int& quadrant) {
+    quadrant = 0;
+    if (!std::isfinite(theta)) return theta - theta;
+    const Real magnitude = std::fabs(theta);
+    if (magnitude <= PI_OVER_4) return theta;
     
-    auto start_time = std::chrono::high_resolution_clock::now();
+    // magnitude = M * 2^E with M a 64-bit integer.
+    int exponent;
+    const Real fraction = std::frexp(magnitude, &exponent);
+    const uint64_t mantissa = static_cast<uint64_t>(std::ldexp(fraction, 64));
+    const int64_t e = static_cast<int64_t>(exponent) - 64;
     
-    KahanSum error_sum;
-    Real max_error = 0.0L;
+    // Split 2/pi = A 2^-(k-1) + T 2^-(k+255) + tail with T the 256 bits from
+    // bit k. For k = e - 1, M 2^e A 2^-(k-1) is a multiple of 4 and drops
+    // out mod 4, so x 2/pi mod 4 = M T 2^-shift with an error below 2^-190.
+    const uint64_t k = static_cast<uint64_t>(std::max<int64_t>(1, e - 1));
+    const uint64_t shift = static_cast<uint64_t>(static_cast<int64_t>(k) + 255 - e);
+    uint64_t product[5];
+    unsigned __int128 carry = 0;
+    for (int w = 0; w < 4; w++) {
+        // Word w of T, least significant first.
+        carry += static_cast<unsigned __int128>(mantissa) * two_over_pi_bits(k + 64 * (3 - w));
+        product[w] = static_cast<uint64_t>(carry);
+        carry >>= 64;
+    }
+    product[4] = static_cast<uint64_t>(carry);
     
-    // Simple sequential version
-    for (size_t i = 0; i < num_samples; i++) {
-        Real theta = rng.uniform(-100.0L * M_PI, 100.0L * M_PI);
-        theta = std::fmod(theta, 2.0L * M_PI);
-        
-        Complex reference(std::cos(theta), std::sin(theta));
-        Complex test_result = exp_taylor_adaptive(Complex(0.0L, theta));
-        
-        Real error = std::abs(reference - test_result);
-        errors.push_back(error);
+    int q = static_cast<int>(extract_bits(product, 5, shift) & 3);
+    unsigned __int128 f = (static_cast<unsigned __int128>(extract_bits(product, 5, shift - 64)) << 64) |
+                          extract_bits(product, 5, shift - 128);
+    // Round to the nearest quadrant: f in [1/2, 1) becomes -(1 - f).
+    bool negative = false;
+    if (f >> 127) {
+        f = -f;
+        q = (q + 1) & 3;
+        negative = true;
     }
     
-    auto end_time = std::chrono::high_resolution_clock::now();
-    benchmark.computation_time_seconds = std::chrono::duration<Real>(end_time - start_time).count();
+    Real r = 0.0L;
+    if (f != 0) {
+        const uint64_t f_hi = static_cast<uint64_t>(f >> 64), f_lo = static_cast<uint64_t>(f);
+        const int lz = f_hi ? __builtin_clzll(f_hi) : 64 + __builtin_clzll(f_lo);
+        f <<= lz;
+        // High 128 bits of f * PIO2_FIXED, i.e. r scaled by 2^(127 + lz).
+        const uint64_t a1 = static_cast<uint64_t>(f >> 64), a0 = static_cast<uint64_t>(f);
+        const uint64_t b1 = static_cast<uint64_t>(PIO2_FIXED >> 64), b0 = static_cast<uint64_t>(PIO2_FIXED);
+        const unsigned __int128 mid = (static_cast<unsigned __int128>(a0) * b0 >> 64) +
+                                      static_cast<uint64_t>(static_cast<unsigned __int128>(a1) * b0) +
+                                      static_cast<uint64_t>(static_cast<unsigned __int128>(a0) * b1);
+        const unsigned __int128 high = static_cast<unsigned __int128>(a1) * b1 +
+                                       (static_cast<unsigned __int128>(a1) * b0 >> 64) +
+                                       (static_cast<unsigned __int128>(a0) * b1 >> 64) + (mid >> 64);
+        r = std::ldexp(static_cast<Real>(static_cast<uint64_t>(high >> 64)), -(63 + lz)) +
+            std::ldexp(static_cast<Real>(static_cast<uint64_t>(high)), -(127 + lz));
+    }
+    if (negative) r = -r;
     
-    for (Real error : errors) {
-        error_sum.add(error);
-        max_error = std::max(max_error, error);
+    if (theta < 0) {
+        r = -r;
+        q = (4 - q) & 3;
+    }
+    quadrant = q;
+    return r;
+}
+
+Complex exp_taylor_adaptive(Complex z, Real tolerance) {
+    // e^(x + iy) = e^x e^(iy): reduce y mod pi/2 exactly, so any y costs the
+    // same, run the series on i r, rotate by the quadrant and scale by e^x.
+    if (std::isfinite(z.real()) && std::fabs(z.imag()) > PI_OVER_4) {
+        int quadrant;
+        const Real r = reduce_pi_over_2(z.imag(), quadrant);
+        Complex w = exp_taylor_unreduced(Complex(0.0L, r), tolerance);
+        switch (quadrant) {
+            case 1: w = Complex(-w.imag(), w.real()); break;
+            case 2: w = -w; break;
+            case 3: w = Complex(w.imag(), -w.real()); break;
+            default: break;
+        }
+        return z.real() == 0 ? w : std::exp(z.real()) * w;
+    }
+    return exp_taylor_unreduced(z, tolerance);
+}
+
+namespace {
+
+// pi/2 = PIO2_1 + PIO2_2 + PIO2_2T. The first two have 33 significant
+// bits, so k * PIO2_1 and k * PIO2_2 are exact for |k| < 2^20.
+constexpr double TWO_OVER_PI = 6.36619772367581382433e-01;
+constexpr double PIO2_1 = 1.57079632673412561417e+00;
+constexpr double PIO2_2 = 6.07710050630396597660e-11;
+constexpr double PIO2_2T = 2.02226624879595063154e-21;
+
+// Minimax coefficients for sin and cos on [-pi/4, pi/4] (fdlibm's
+// __kernel_sin and __kernel_cos), about 1 ulp.
+constexpr double S1 = -1.66666666666666324348e-01, S2 = 8.33333333332248946124e-03,
+                 S3 = -1.98412698298579493134e-04, S4 = 2.75573137070700676789e-06,
+                 S5 = -2.50507602534068634195e-08, S6 = 1.58969099521155010221e-10;
+constexpr double C1 = 4.16666666666666019037e-02, C2 = -1.38888888888741095749e-03,
+                 C3 = 2.48015872894767294178e-05, C4 = -2.75573143513906633035e-07,
+                 C5 = 2.08757232129817482790e-09, C6 = -1.13596475577881948265e-11;
+
+inline void exp_i_scalar(double theta, double& re, double& im) {
+    int k;
+    double r;
+    if (std::fabs(theta) <= EXP_I_REDUCTION_LIMIT) {
+        const double y = theta * TWO_OVER_PI;
+        k = static_cast<int>(y + std::copysign(0.5, y));
+        const double kd = k;
+        r = ((theta - kd * PIO2_1) - kd * PIO2_2) - kd * PIO2_2T;
+    } else {
+        // NaN for infinite or NaN theta.
+        r = static_cast<double>(reduce_pi_over_2(theta, k));
+    }
+    const double z = r * r;
+    const double s = r + r * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+    const double c = (1.0 - 0.5 * z) + z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+
+    // theta = k pi/2 + r: quadrant q rotates (cos r, sin r) by q quarter
+    // turns. Table lookups instead of branches, since q is random.
+    static constexpr double COS_SIGN[4] = {1.0, -1.0, -1.0, 1.0};
+    static constexpr double SIN_SIGN[4] = {1.0, 1.0, -1.0, -1.0};
+    const int q = k & 3;
+    const double parts[2] = {c, s};
+    re = COS_SIGN[q] * parts[q & 1];
+    im = SIN_SIGN[q] * parts[(q & 1) ^ 1];
+}
+
+}
+
+void exp_i_batch(const double* theta, size_t count, double* re, double* im) {
+    size_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    const __m256d limit = _mm256_set1_pd(EXP_I_REDUCTION_LIMIT);
+    const __m256d one = _mm256_set1_pd(1.0), half = _mm256_set1_pd(0.5);
+    const __m256i one_bit = _mm256_set1_epi64x(1), two_bit = _mm256_set1_epi64x(2);
+    for (; i + 4 <= count; i += 4) {
+        const __m256d x = _mm256_loadu_pd(theta + i);
+        // Any lane out of range (or NaN) sends the whole group to the
+        // scalar path.
+        if (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_and_pd(x, abs_mask), limit, _CMP_LE_OQ)) != 0xF) {
+            for (size_t j = i; j < i + 4; ++j) exp_i_scalar(theta[j], re[j], im[j]);
+            continue;
+        }
+        const __m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(TWO_OVER_PI)),
+                                          _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(PIO2_1), x);
+        r = _mm256_fnmadd_pd(k, _mm256_set1_pd(PIO2_2), r);
+        r = _mm256_fnmadd_pd(k, _mm256_set1_pd(PIO2_2T), r);
+        const __m256d z = _mm256_mul_pd(r, r);
+
+        __m256d ps = _mm256_fmadd_pd(_mm256_set1_pd(S6), z, _mm256_set1_pd(S5));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S4));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S3));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S2));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S1));
+        const __m256d s = _mm256_fmadd_pd(_mm256_mul_pd(r, z), ps, r);
+
+        __m256d pc = _mm256_fmadd_pd(_mm256_set1_pd(C6), z, _mm256_set1_pd(C5));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C4));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C3));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C2));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C1));
+        const __m256d c = _mm256_fmadd_pd(_mm256_mul_pd(z, z), pc, _mm256_fnmadd_pd(half, z, one));
+
+        const __m256i q = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k));
+        const __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(q, one_bit), one_bit));
+        const __m256d cos_part = _mm256_blendv_pd(c, s, swap);
+        const __m256d sin_part = _mm256_blendv_pd(s, c, swap);
+        // Sign flips: cos for q = 1, 2 (bit 1 of q + 1), sin for q = 2, 3 (bit 1 of q).
+        const __m256d cos_sign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(q, one_bit), two_bit), 62));
+        const __m256d sin_sign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(q, two_bit), 62));
+        _mm256_storeu_pd(re + i, _mm256_xor_pd(cos_part, cos_sign));
+        _mm256_storeu_pd(im + i, _mm256_xor_pd(sin_part, sin_sign));
     }
+#endif
+    for (; i < count; ++i) exp_i_scalar(theta[i], re[i], im[i]);
+}
+
+ComplexBenchmark benchmark_euler_formula(size_t num_samples, size_t num_threads, uint64_t seed) {
+    ComplexBenchmark benchmark;
+    benchmark.samples = num_samples;
     
-    benchmark.max_absolute_error = max_error;
-    benchmark.mean_absolute_error = error_sum.get() / static_cast<Real>(num_samples);
+    // Block b draws its angles from StreamRNG::keyed(seed, b) and keeps its
+    // own StreamingErrorStats; blocks are merged in index order. Neither the
+    // angles nor the merge order depend on which thread ran a block, so
+    // every statistic is bit-identical for any thread count, and nothing is
+    // stored per sample.
+    constexpr uint64_t BLOCK = 4096;
     
-    KahanSum variance_sum;
-    Real mean = benchmark.mean_absolute_error;
-    for (Real error : errors) {
-        Real diff = error - mean;
-        variance_sum.add(diff * diff);
-    }
-    benchmark.std_deviation_error = std::sqrt(variance_sum.get() / static_cast<Real>(num_samples - 1));
+    auto start_time = std::chrono::high_resolution_clock::now();
     
-    for (Real error : errors) {
-        int bin = static_cast<int>(std::min(99.0L, error / max_error * 99));
-        benchmark.error_histogram[bin]++;
-    }
+    benchmark.error_stats = parallel::parallel_reduce(0, num_samples, BLOCK, StreamingErrorStats(), [&](uint64_t first, uint64_t last) {
+        StreamRNG rng = StreamRNG::keyed(seed, first / BLOCK);
+        StreamingErrorStats stats;
+        for (uint64_t i = first; i < last; i++) {
+            Real theta = rng.uniform(-100.0L * M_PI, 100.0L * M_PI);
+            theta = std::fmod(theta, 2.0L * M_PI);
+            
+            Complex reference(std::cos(theta), std::sin(theta));
+            Complex test_result = exp_taylor_adaptive(Complex(0.0L, theta));
+            
+            stats.add(std::abs(reference - test_result));
+        }
+        return stats;
+    }, [](StreamingErrorStats a, const StreamingErrorStats& b) {
+        a.merge(b);
+        return a;
+    }, num_threads);
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    benchmark.computation_time_seconds = std::chrono::duration<Real>(end_time - start_time).count();
+    
+    benchmark.max_absolute_error = benchmark.error_stats.max();
+    benchmark.mean_absolute_error = benchmark.error_stats.mean();
+    benchmark.std_deviation_error = benchmark.error_stats.std_deviation();
     
     return benchmark;
 }
@@ -1,30 +1,155 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
 #include <algorithm>
 #include <numeric>
 #include <thread>
 #include <chrono>
+#include <map>
+#include <stdexcept>
 #include "config.h"
 #include "number_theory.h"
+#include "multiprecision.h"
+#include "result_io.h"
+#include "result_sink.h"
+#include "pseudoprime.h"
 #include "complex_analysis.h"
+#include "zeta.h"
 #include "topology.h"
 #include "progress.h"
+#include "thread_pool.h"
 #ifndef NO_VISUALIZATION
 #include "visualization.h"
 #endif
 
-uint64_t mod_pow(uint64_t base, uint64_t exp, uint64_t mod) {
-    uint64_t result = 1;
-    base %= mod;
-    while (exp > 0) {
-        if (exp & 1) result = ((__uint128_t)result * base) % mod;
-        base = ((__uint128_t)base * base) % mod;
-        exp >>= 1;
+// Single-threaded reference: plain square-and-multiply, phi(n) by
+// factorisation, bases from StreamRNG::keyed(seed, n) as in the batch
+// tester.
+number_theory::EulerTestResult run_naive_engine(uint64_t max_n, size_t tests_per_n, uint64_t seed,
+                                                size_t max_counterexamples) {
+    number_theory::EulerTestResult result;
+    auto start_time = std::chrono::steady_clock::now();
+    ProgressTracker progress(max_n >= 2 ? max_n - 1 : 0, "Number Theory Tests");
+
+    for (uint64_t n = 2; n <= max_n; ++n) {
+        if (n < 3) {
+            result.skipped_tests += tests_per_n;
+            progress.update(1);
+            continue;
+        }
+        StreamRNG rng = StreamRNG::keyed(seed, n);
+        const uint64_t phi_n = number_theory::euler_phi(n);
+        for (size_t test = 0; test < tests_per_n; ++test) {
+            const uint64_t a = rng.uniform<uint64_t>(2, n - 1);
+            if (std::gcd(a, n) != 1) {
+                result.skipped_tests++;
+                continue;
+            }
+            result.total_tests++;
+            if (number_theory::mod_pow(a, phi_n, n) == 1) {
+                result.passed_tests++;
+            } else if (result.counterexamples.size() < max_counterexamples) {
+                result.counterexamples.emplace_back(a, n, phi_n);
+            }
+        }
+        progress.update(1);
     }
+    progress.finish();
+
+    result.avg_computation_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
     return result;
 }
 
+// Euler's theorem for one modulus given as (prime, exponent) pairs, in
+// N-limb arithmetic. phi(n) comes from the factorisation, so every factor
+// is checked with Miller-Rabin first. Throws std::overflow_error when a
+// factor or n needs more than N limbs.
+template<size_t N>
+int run_wide_engine(const std::vector<std::pair<std::string, int>>& factors, size_t tests, uint64_t seed) {
+    std::map<number_theory::UInt<N>, int> parsed;
+    for (const auto& [text, k] : factors) {
+        const auto p = number_theory::UInt<N>::from_string(text);
+        if (!number_theory::is_prime_miller_rabin(p)) {
+            std::cerr << "Factor " << text << " is not prime\n";
+            return 1;
+        }
+        parsed[p] += k;
+    }
+
+    StreamRNG rng(seed);
+    const auto result = number_theory::test_euler_theorem_wide(parsed, tests, rng);
+    const size_t failed_tests = result.total_tests - result.passed_tests;
+
+    std::cout << "Arithmetic: " << 64 * N << "-bit Montgomery\n";
+    std::cout << "\n+---------------------------------+\n";
+    std::cout << "|          RESULTS                |\n";
+    std::cout << "+---------------------------------+\n";
+    std::cout << "Total tests executed: " << result.total_tests << "\n";
+    std::cout << "Tests passed:         " << result.passed_tests << "\n";
+    std::cout << "Tests skipped:        " << result.skipped_tests << "\n";
+    std::cout << "Failures found:       " << failed_tests << "\n";
+    std::cout << "Computation time:     " << result.avg_computation_time << "s\n\n";
+
+    for (const auto& [a, n, phi] : result.counterexamples) {
+        std::cout << "  counterexample: a=" << a.to_string() << " n=" << n.to_string()
+                  << " phi(n)=" << phi.to_string() << "\n";
+    }
+
+    if (failed_tests == 0) {
+        std::cout << "✓ PROOF STATUS: ALL TESTS PASSED - Euler's theorem holds computationally\n";
+        return 0;
+    }
+    std::cout << "✗ PROOF STATUS: " << failed_tests << " FAILURES DETECTED\n";
+    return 1;
+}
+
+// Shared RESULTS block for every number engine and merged shard reports.
+int print_number_report(const number_theory::EulerTestResult& result) {
+    const size_t failed_tests = result.total_tests - result.passed_tests;
+
+    std::cout << "\n+---------------------------------+\n";
+    std::cout << "|          RESULTS                |\n";
+    std::cout << "+---------------------------------+\n";
+    std::cout << "Total tests executed: " << result.total_tests << "\n";
+    std::cout << "Tests passed:         " << result.passed_tests << "\n";
+    std::cout << "Tests skipped:        " << result.skipped_tests << "\n";
+    if (result.sampled_tests > 0) {
+        std::cout << "Bases sampled as units: " << result.sampled_tests << "\n";
+    }
+    std::cout << "Failures found:       " << failed_tests << "\n";
+    std::cout << "Success rate:         " << (result.total_tests > 0 ? (100.0 * result.passed_tests / result.total_tests) : 0) << "%\n";
+    std::cout << "Computation time:     " << result.avg_computation_time << "s\n";
+    if (result.avg_computation_time > 0) {
+        std::cout << "Throughput:           " << std::fixed << std::setprecision(0)
+                  << result.total_tests / result.avg_computation_time << " tests/s\n";
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setprecision(6);
+    }
+    if (result.verified_units > 0) {
+        std::cout << "Units verified:       " << result.verified_units << "\n";
+    }
+    std::cout << "\n";
+
+    for (const auto& [a, n, phi] : result.counterexamples) {
+        std::cout << "  counterexample: a=" << a << " n=" << n << " phi(n)=" << phi << "\n";
+    }
+    if (failed_tests > result.counterexamples.size()) {
+        std::cout << "  ... " << failed_tests - result.counterexamples.size()
+                  << " more not listed (raise --max-counterexamples, or --records FILE keeps all)\n";
+    }
+
+    if (failed_tests == 0) {
+        std::cout << "✓ PROOF STATUS: ALL TESTS PASSED - Euler's theorem holds computationally\n";
+        return 0;
+    } else {
+        std::cout << "✗ PROOF STATUS: " << failed_tests << " FAILURES DETECTED\n";
+        return 1;
+    }
+}
+
 void print_usage(const char* prog) {
     std::cout << "\n+=======================================+\n";
     std::cout << "| EULER COMPUTATIONAL PROOF SYSTEM      |\n";
@@ -38,7 +163,39 @@ void print_usage(const char* prog) {
     std::cout << "  number    - Euler's theorem: a^φ(n) ≡ 1 (mod n) for gcd(a,n)=1\n";
     std::cout << "  complex   - Euler's formula: e^(iθ) = cos θ + i sin θ  \n";
     std::cout << "  topology  - Euler characteristic: V - E + F = 2 for polyhedra\n";
-    std::cout << "  ultra     - Ultra precision method comparison for e^(iθ)\n\n";
+    std::cout << "  ultra     - Ultra precision method comparison for e^(iθ)\n";
+    std::cout << "  merge     - Combine shard results written by number --output\n";
+    std::cout << "  wide      - Euler's theorem for one 128- or 256-bit modulus given by its factorisation\n";
+    std::cout << "  pseudoprime - Carmichael numbers and Fermat/Euler pseudoprimes up to a bound\n\n";
+
+    std::cout << "GLOBAL OPTIONS:\n";
+    std::cout << "  --pin-threads              Pin worker threads to CPUs, one NUMA node at a time\n\n";
+
+    std::cout << "NUMBER OPTIONS: number <max_n> [tests_per_n] [threads]\n";
+    std::cout << "  --engine=E                 naive, stress, batch (default) or exhaustive\n";
+    std::cout << "  --threads N                Worker threads (default: hardware concurrency)\n";
+    std::cout << "  --checkpoint FILE          Save progress to FILE periodically (batch)\n";
+    std::cout << "  --checkpoint-interval S    Seconds between checkpoints (default 60)\n";
+    std::cout << "  --resume                   Continue from the checkpoint file\n";
+    std::cout << "  --shard i/N                Test slice i (0-based) of N equal slices of [2, max_n]\n";
+    std::cout << "  --range L:R                Test L <= n <= R\n";
+    std::cout << "  --output FILE              Write the result for euler merge\n";
+    std::cout << "  --records FILE             Stream every counterexample to FILE (40-byte records)\n";
+    std::cout << "  --record-moduli            Also write one summary record per n\n";
+    std::cout << "  --unit-sampler             Draw bases directly as units instead of rejecting gcd(a,n) > 1\n";
+    std::cout << "  --max-counterexamples N    Counterexamples kept in the report (default 100)\n\n";
+
+    std::cout << "WIDE OPTIONS: wide <p^k*q*...> [tests] [seed]\n";
+    std::cout << "  Factors are decimal or 0x hex; 128-bit arithmetic when n fits, else 256-bit\n\n";
+
+    std::cout << "COMPLEX OPTIONS: complex <samples> [precision] [threads]\n";
+    std::cout << "  --kernel=K                 batch (SIMD polynomial, default) or taylor (long double reference)\n\n";
+
+    std::cout << "PSEUDOPRIME OPTIONS: pseudoprime <bound> [threads]\n";
+    std::cout << "  --bases 2,3,5              Bases for Fermat/Euler pseudoprimes (default 2)\n";
+    std::cout << "  --carmichael-only          Skip the per-base exponentiations\n";
+    std::cout << "  --list                     Print each hit\n";
+    std::cout << "  --records FILE             Stream hits to FILE (40-byte records)\n\n";
     
     std::cout << "VISUALIZATION MODES:\n";
     std::cout << "  euler     - Visualize Euler's formula in 3D\n";
@@ -48,12 +205,30 @@ void print_usage(const char* prog) {
     
     std::cout << "EXAMPLES:\n";
     std::cout << "  " << prog << " number 10000 20        # Test Euler's theorem up to n=10000\n";
+    std::cout << "  " << prog << " number 100000 20 --engine=stress --threads 8  # Work-stealing tester\n";
+    std::cout << "  " << prog << " number 100000 --engine=exhaustive  # Prove it for every unit\n";
+    std::cout << "  " << prog << " number 10000000000 20 64 --checkpoint run.ckpt --resume  # Resumable long run\n";
+    std::cout << "  " << prog << " number 1000000 20 --shard 0/4 --output s0.bin  # One of four shards\n";
+    std::cout << "  " << prog << " merge s0.bin s1.bin s2.bin s3.bin  # Combine shard results\n";
+    std::cout << "  " << prog << " wide 2^5*170141183460469231731687303715884105727 1000  # 2^5 (2^127 - 1)\n";
     std::cout << "  " << prog << " complex 1000000 1e-12  # Test Euler's formula with high precision\n";
     std::cout << "  " << prog << " visualize topology icosphere 4  # Visualize level 4 icosphere\n";
-    std::cout << "  " << prog << " viz complex euler 800   # Visualize Euler's formula at 800x800 resolution\n\n";
+    std::cout << "  " << prog << " viz complex euler 800   # Visualize Euler's formula at 800x800 resolution\n";
+    std::cout << "  " << prog << " viz complex zeta 2000   # Domain coloring of the Riemann zeta function\n\n";
 }
 
 int main(int argc, char** argv) {
+    // --pin-threads applies to every mode, so it is taken out before the
+    // per-mode argument parsing.
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--pin-threads") {
+            parallel::global_pool().set_pinning(true);
+            std::copy(argv + i + 1, argv + argc, argv + i);
+            --argc;
+            --i;
+        }
+    }
+
     if (argc < 2) {
         print_usage(argv[0]);
         return 1;
@@ -68,106 +243,358 @@ int main(int argc, char** argv) {
         std::cout << "+=======================================+\n";
         std::cout << "Testing: a^φ(n) ≡ 1 (mod n) for gcd(a,n) = 1\n";
 
-        int max_n = (argc > 2) ? std::stoi(argv[2]) : 1000;
-        int tests_per_n = (argc > 3) ? std::stoi(argv[3]) : 10;
-        int num_threads = (argc > 4) ? std::stoi(argv[4]) : std::thread::hardware_concurrency();
+        std::vector<std::string> args;
+        std::string checkpoint_path, output_path, range, shard, records_path, engine, threads;
+        double checkpoint_interval = 60.0;
+        size_t max_counterexamples = 100;
+        bool resume = false, record_moduli = false, unit_sampler = false;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--engine=", 0) == 0) engine = arg.substr(9);
+            else if (arg == "--engine" && i + 1 < argc) engine = argv[++i];
+            else if (arg.rfind("--threads=", 0) == 0) threads = arg.substr(10);
+            else if (arg == "--threads" && i + 1 < argc) threads = argv[++i];
+            else if (arg == "--checkpoint" && i + 1 < argc) checkpoint_path = argv[++i];
+            else if (arg == "--output" && i + 1 < argc) output_path = argv[++i];
+            else if (arg == "--range" && i + 1 < argc) range = argv[++i];
+            else if (arg == "--shard" && i + 1 < argc) shard = argv[++i];
+            else if (arg == "--checkpoint-interval" && i + 1 < argc) checkpoint_interval = std::stod(argv[++i]);
+            else if (arg == "--resume") resume = true;
+            else if (arg == "--records" && i + 1 < argc) records_path = argv[++i];
+            else if (arg == "--record-moduli") record_moduli = true;
+            else if (arg == "--unit-sampler") unit_sampler = true;
+            else if (arg == "--max-counterexamples" && i + 1 < argc) max_counterexamples = std::stoul(argv[++i]);
+            else args.push_back(arg);
+        }
+
+        uint64_t max_n = (args.size() > 0) ? std::stoull(args[0]) : 1000;
+        int tests_per_n = (args.size() > 1) ? std::stoi(args[1]) : 10;
+        if (args.size() > 2 && threads.empty()) threads = args[2];
+        size_t num_threads = threads.empty() ? std::thread::hardware_concurrency() : std::stoul(threads);
+        if (num_threads == 0) num_threads = 1;
+
+        if (engine.empty()) engine = "batch";
+        std::transform(engine.begin(), engine.end(), engine.begin(), ::tolower);
+        if (engine != "naive" && engine != "stress" && engine != "batch" && engine != "exhaustive") {
+            std::cerr << "Unknown engine '" << engine << "'; expected naive, stress, batch or exhaustive\n";
+            return 1;
+        }
+        // Checkpoints, ranges and shard output exist only in the batch
+        // tester; records and unit sampling also work in the stress tester.
+        const bool batch_only = !checkpoint_path.empty() || !output_path.empty() || !range.empty() || !shard.empty();
+        const bool sampled = !records_path.empty() || unit_sampler;
+        if ((batch_only && engine != "batch") || (sampled && engine != "batch" && engine != "stress")) {
+            std::cerr << "These options are not supported by --engine=" << engine << "\n";
+            return 1;
+        }
 
         std::cout << "Parameters: max_n=" << max_n << ", tests_per_n=" << tests_per_n 
-                  << ", threads=" << num_threads << "\n\n";
+                  << ", threads=" << (engine == "naive" ? 1 : num_threads) << ", engine=" << engine << "\n\n";
+
+        std::unique_ptr<number_theory::FileResultSink> sink;
+        if (!records_path.empty()) {
+            sink.reset(new number_theory::FileResultSink(records_path, resume));
+            if (!sink->is_open()) {
+                std::cerr << "Cannot open " << records_path << "\n";
+                return 1;
+            }
+        }
 
-        auto start_time = std::chrono::high_resolution_clock::now();
-        std::cout << "Starting computation...\n";
+        if (engine == "naive") {
+            std::cout << "Starting computation...\n";
+            return print_number_report(run_naive_engine(max_n, tests_per_n, config::RNG_DEFAULT_SEED, max_counterexamples));
+        }
+        if (engine == "exhaustive") {
+            std::cout << "Starting computation...\n";
+            return print_number_report(number_theory::exhaustive_test_euler_theorem(max_n, num_threads, max_counterexamples));
+        }
+        if (engine == "stress") {
+            number_theory::StressTestConfig config;
+            config.num_threads = num_threads;
+            config.sink = sink.get();
+            config.record_moduli = record_moduli;
+            config.use_unit_sampler = unit_sampler;
+            std::cout << "Starting computation...\n";
+            auto result = number_theory::stress_test_euler_theorem(max_n, tests_per_n, max_counterexamples, config);
+            if (sink) std::cout << "Records written to " << records_path << "\n";
+            return print_number_report(result);
+        }
 
-        int total_tests = 0;
-        int passed_tests = 0;
-        int failed_tests = 0;
-        int skipped_tests = 0;
+        number_theory::BatchTestConfig config;
+        config.num_threads = num_threads;
+        config.checkpoint_path = checkpoint_path;
+        config.checkpoint_interval = checkpoint_interval;
+        config.resume = resume;
+        config.use_unit_sampler = unit_sampler;
+        config.max_counterexamples = max_counterexamples;
+        config.sink = sink.get();
+        config.record_moduli = record_moduli;
+
+        if (!range.empty()) {
+            const size_t colon = range.find(':');
+            if (colon == std::string::npos) {
+                std::cerr << "--range expects L:R\n";
+                return 1;
+            }
+            config.first_n = std::stoull(range.substr(0, colon));
+            max_n = std::stoull(range.substr(colon + 1));
+        } else if (!shard.empty()) {
+            const size_t slash = shard.find('/');
+            const uint64_t index = slash == std::string::npos ? 0 : std::stoull(shard.substr(0, slash));
+            const uint64_t count = slash == std::string::npos ? 0 : std::stoull(shard.substr(slash + 1));
+            if (count == 0 || index >= count) {
+                std::cerr << "--shard expects i/N with 0 <= i < N\n";
+                return 1;
+            }
+            // Shard i of N covers [2 + span*i/N, 2 + span*(i+1)/N).
+            const uint64_t span = max_n >= 2 ? max_n - 1 : 0;
+            config.first_n = 2 + static_cast<uint64_t>(static_cast<number_theory::u128>(span) * index / count);
+            max_n = 1 + static_cast<uint64_t>(static_cast<number_theory::u128>(span) * (index + 1) / count);
+        }
+        if (config.first_n != 2) {
+            std::cout << "Range: [" << config.first_n << ", " << max_n << "]\n";
+        }
 
-        ProgressTracker progress(max_n - 1, "Number Theory Tests");
+        number_theory::Checkpoint previous;
+        if (resume && !checkpoint_path.empty() && number_theory::load_checkpoint(checkpoint_path, previous)) {
+            std::cout << "Resuming from " << checkpoint_path << " at n=" << previous.next_n << "\n";
+        }
+        std::cout << "Starting computation...\n";
 
-        for (int n = 2; n <= max_n; ++n) {
-            for (int test = 0; test < tests_per_n; ++test) {
-                int a = 2 + (std::rand() % (n - 1));
-                
-                if (std::__gcd(a, n) != 1) {
-                    skipped_tests++;
-                    continue;
-                }
+        auto result = number_theory::batch_test_euler_theorem(max_n, tests_per_n, config);
+
+        if (!output_path.empty()) {
+            number_theory::ShardResult shard_result;
+            shard_result.first_n = config.first_n;
+            shard_result.max_n = max_n;
+            shard_result.tests_per_n = tests_per_n;
+            shard_result.seed = config.seed;
+            shard_result.use_unit_sampler = config.use_unit_sampler;
+            shard_result.result = result;
+            if (!number_theory::save_shard_result(output_path, shard_result)) {
+                std::cerr << "Failed to write " << output_path << "\n";
+                return 1;
+            }
+            std::cout << "Result written to " << output_path << "\n";
+        }
+        if (sink) std::cout << "Records written to " << records_path << "\n";
+        return print_number_report(result);
+    }
+    
+    else if (mode == "pseudoprime") {
+        std::cout << "\n+=======================================+\n";
+        std::cout << "| PSEUDOPRIME ENUMERATION               |\n";
+        std::cout << "+=======================================+\n";
 
-                uint64_t phi_n = number_theory::euler_phi(n);
-                uint64_t result = mod_pow(a, phi_n, n);
-                
-                total_tests++;
-                if (result == 1) {
-                    passed_tests++;
-                } else {
-                    failed_tests++;
+        std::vector<std::string> args;
+        std::string records_path;
+        bool list = false;
+        number_theory::PseudoprimeConfig config;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--bases" && i + 1 < argc) {
+                config.bases.clear();
+                std::string bases = argv[++i];
+                for (size_t pos = 0; pos < bases.size();) {
+                    size_t comma = bases.find(',', pos);
+                    if (comma == std::string::npos) comma = bases.size();
+                    config.bases.push_back(std::stoull(bases.substr(pos, comma - pos)));
+                    pos = comma + 1;
                 }
             }
-            progress.update(n - 1);
+            else if (arg == "--records" && i + 1 < argc) records_path = argv[++i];
+            else if (arg == "--list") list = true;
+            else if (arg == "--carmichael-only") config.fermat = config.euler = false;
+            else args.push_back(arg);
         }
 
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
+        uint64_t bound = (args.size() > 0) ? std::stoull(args[0]) : 1000000;
+        config.num_threads = (args.size() > 1) ? std::stoul(args[1]) : 0;
+
+        std::cout << "Bound: " << bound << ", bases:";
+        for (uint64_t b : config.bases) std::cout << " " << b;
+        std::cout << "\n\n";
+
+        std::unique_ptr<number_theory::ResultSink> sink;
+        if (!records_path.empty()) {
+            auto file_sink = std::make_unique<number_theory::FileResultSink>(records_path);
+            if (!file_sink->is_open()) {
+                std::cerr << "Cannot open " << records_path << "\n";
+                return 1;
+            }
+            sink = std::move(file_sink);
+        } else if (list) {
+            // Hits are printed as they are flushed, unordered across segments.
+            sink = std::make_unique<number_theory::CallbackResultSink>(
+                [](const number_theory::ResultRecord* records, size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        const auto& r = records[i];
+                        if (r.kind == number_theory::RecordKind::Carmichael) std::cout << "carmichael " << r.n << "\n";
+                        else if (r.kind == number_theory::RecordKind::FermatPseudoprime) std::cout << "fermat(" << r.a << ") " << r.n << "\n";
+                        else if (r.kind == number_theory::RecordKind::EulerPseudoprime) std::cout << "euler(" << r.a << ") " << r.n << "\n";
+                    }
+                });
+        }
+        config.sink = sink.get();
+
+        auto result = number_theory::enumerate_pseudoprimes(0, bound + 1, config);
 
         std::cout << "\n+---------------------------------+\n";
         std::cout << "|          RESULTS                |\n";
         std::cout << "+---------------------------------+\n";
-        std::cout << "Total tests executed: " << total_tests << "\n";
-        std::cout << "Tests passed:         " << passed_tests << "\n";
-        std::cout << "Tests skipped:        " << skipped_tests << "\n";
-        std::cout << "Failures found:       " << failed_tests << "\n";
-        std::cout << "Success rate:         " << (total_tests > 0 ? (100.0 * passed_tests / total_tests) : 0) << "%\n";
-        std::cout << "Computation time:     " << duration.count() << "s\n\n";
+        std::cout << "Odd numbers scanned:  " << result.odd_numbers << "\n";
+        if (config.carmichael) std::cout << "Carmichael numbers:   " << result.carmichael << "\n";
+        for (size_t b = 0; b < config.bases.size(); ++b) {
+            if (config.fermat) std::cout << "Fermat psp base " << config.bases[b] << ":    " << result.fermat[b] << "\n";
+            if (config.euler) std::cout << "Euler psp base " << config.bases[b] << ":     " << result.euler[b] << "\n";
+        }
+        std::cout << "Computation time:     " << result.computation_time << "s\n";
+        if (!records_path.empty()) std::cout << "Records written to " << records_path << "\n";
+        return 0;
+    }
 
-        if (failed_tests == 0) {
-            std::cout << "✓ PROOF STATUS: ALL TESTS PASSED - Euler's theorem holds computationally\n";
-            return 0;
-        } else {
-            std::cout << "✗ PROOF STATUS: " << failed_tests << " FAILURES DETECTED\n";
+    else if (mode == "merge") {
+        if (argc < 3) {
+            std::cerr << "Usage: " << argv[0] << " merge <shard files...>\n";
+            return 1;
+        }
+
+        std::vector<number_theory::ShardResult> shards;
+        for (int i = 2; i < argc; ++i) {
+            number_theory::ShardResult shard;
+            if (!number_theory::load_shard_result(argv[i], shard)) {
+                std::cerr << "Cannot read shard result " << argv[i] << "\n";
+                return 1;
+            }
+            shards.push_back(std::move(shard));
+        }
+
+        number_theory::ShardResult merged;
+        std::string error;
+        if (!number_theory::merge_shard_results(std::move(shards), merged, error)) {
+            std::cerr << "Cannot merge: " << error << "\n";
             return 1;
         }
+
+        std::cout << "\n+=======================================+\n";
+        std::cout << "| EULER'S THEOREM - MERGED SHARDS       |\n";
+        std::cout << "+=======================================+\n";
+        std::cout << "Shards: " << (argc - 2) << ", range [" << merged.first_n << ", " << merged.max_n
+                  << "], tests_per_n=" << merged.tests_per_n
+                  << (merged.use_unit_sampler ? ", unit sampler" : "") << "\n";
+        std::cout << "(computation time is summed over shards)\n";
+        return print_number_report(merged.result);
     }
-    
+
+    else if (mode == "wide") {
+        if (argc < 3) {
+            std::cerr << "Usage: " << argv[0] << " wide <p^k*q*...> [tests] [seed]\n";
+            return 1;
+        }
+        std::cout << "\n+=======================================+\n";
+        std::cout << "| EULER'S THEOREM - WIDE MODULUS        |\n";
+        std::cout << "+=======================================+\n";
+
+        const std::string text = argv[2];
+        size_t tests = (argc > 3) ? std::stoul(argv[3]) : 1000;
+        uint64_t seed = (argc > 4) ? std::stoull(argv[4]) : config::RNG_DEFAULT_SEED;
+
+        std::vector<std::pair<std::string, int>> factors;
+        for (size_t pos = 0; pos < text.size();) {
+            size_t star = text.find('*', pos);
+            if (star == std::string::npos) star = text.size();
+            const std::string factor = text.substr(pos, star - pos);
+            const size_t caret = factor.find('^');
+            factors.emplace_back(factor.substr(0, caret), caret == std::string::npos ? 1 : std::stoi(factor.substr(caret + 1)));
+            pos = star + 1;
+        }
+        std::cout << "Modulus: " << text << ", tests: " << tests << "\n";
+
+        try {
+            try {
+                return run_wide_engine<2>(factors, tests, seed);
+            } catch (const std::overflow_error&) {
+                // Does not fit in 128 bits; retry with 256.
+            }
+            return run_wide_engine<4>(factors, tests, seed);
+        } catch (const std::exception& e) {
+            std::cerr << "wide: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
     else if (mode == "complex") {
         std::cout << "\n+=======================================+\n";
         std::cout << "| EULER'S FORMULA COMPUTATIONAL PROOF   |\n";
         std::cout << "+=======================================+\n";
         std::cout << "Testing: e^(iθ) = cos θ + i sin θ\n";
 
-        int samples = (argc > 2) ? std::stoi(argv[2]) : 1000000;
-        double precision = (argc > 3) ? std::stod(argv[3]) : 1e-12;
-        int num_threads = (argc > 4) ? std::stoi(argv[4]) : std::thread::hardware_concurrency();
+        std::vector<std::string> args;
+        std::string kernel = "batch";
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--kernel=", 0) == 0) kernel = arg.substr(9);
+            else if (arg == "--kernel" && i + 1 < argc) kernel = argv[++i];
+            else args.push_back(arg);
+        }
+        if (kernel != "batch" && kernel != "taylor") {
+            std::cerr << "Unknown kernel '" << kernel << "'; expected batch or taylor\n";
+            return 1;
+        }
+
+        uint64_t samples = (args.size() > 0) ? std::stoull(args[0]) : 1000000;
+        double precision = (args.size() > 1) ? std::stod(args[1]) : 1e-12;
+        size_t num_threads = (args.size() > 2) ? std::stoul(args[2]) : std::thread::hardware_concurrency();
 
         std::cout << "Parameters: samples=" << samples << ", precision=" << precision 
-                  << ", threads=" << num_threads << "\n\n";
+                  << ", threads=" << num_threads << ", kernel=" << kernel << "\n\n";
 
         auto start_time = std::chrono::high_resolution_clock::now();
         std::cout << "Starting computation...\n";
 
-        int passed_tests = 0;
-        int failed_tests = 0;
-        double max_error = 0.0;
-
+        // theta_i = -10 + 20 i / samples, checked against std::cos/std::sin
+        // in blocks. batch runs exp_i_batch over the block; taylor runs the
+        // long double exp_taylor_adaptive per sample.
+        struct Tally {
+            uint64_t passed = 0;
+            double max_error = 0.0;
+        };
+        constexpr uint64_t BLOCK = 4096;
         ProgressTracker progress(samples, "Complex Analysis Tests");
-
-        for (int i = 0; i < samples; ++i) {
-            double theta = -10.0 + 20.0 * i / samples;
-            
-            complex_analysis::Complex euler_result = complex_analysis::exp_taylor_adaptive(complex_analysis::Complex(0, theta));
-            complex_analysis::Complex expected(std::cos(theta), std::sin(theta));
-            
-            double error = std::abs(euler_result - expected);
-            max_error = std::max(max_error, error);
-            
-            if (error < precision) {
-                passed_tests++;
+        std::mutex progress_mutex;
+        const Tally tally = parallel::parallel_reduce(0, samples, BLOCK, Tally{}, [&](uint64_t first, uint64_t last) {
+            double theta[BLOCK], re[BLOCK], im[BLOCK];
+            const size_t count = last - first;
+            for (size_t i = 0; i < count; ++i) theta[i] = -10.0 + 20.0 * (first + i) / samples;
+            if (kernel == "batch") {
+                complex_analysis::exp_i_batch(theta, count, re, im);
             } else {
-                failed_tests++;
+                for (size_t i = 0; i < count; ++i) {
+                    const auto z = complex_analysis::exp_taylor_adaptive(complex_analysis::Complex(0, theta[i]));
+                    re[i] = static_cast<double>(z.real());
+                    im[i] = static_cast<double>(z.imag());
+                }
             }
-            
-            if (i % 10000 == 0) progress.update(i);
-        }
+            Tally t;
+            for (size_t i = 0; i < count; ++i) {
+                const double error = std::hypot(re[i] - std::cos(theta[i]), im[i] - std::sin(theta[i]));
+                t.max_error = std::max(t.max_error, error);
+                if (error < precision) t.passed++;
+            }
+            if (first / BLOCK % 256 == 0) {
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                progress.update(std::min<uint64_t>(256 * BLOCK, samples - first));
+            }
+            return t;
+        }, [](Tally a, const Tally& b) {
+            a.passed += b.passed;
+            a.max_error = std::max(a.max_error, b.max_error);
+            return a;
+        }, num_threads);
+
+        const uint64_t passed_tests = tally.passed;
+        const uint64_t failed_tests = samples - passed_tests;
+        const double max_error = tally.max_error;
 
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time);
@@ -178,9 +605,10 @@ int main(int argc, char** argv) {
         std::cout << "Total tests executed: " << samples << "\n";
         std::cout << "Tests passed:         " << passed_tests << "\n";
         std::cout << "Failures found:       " << failed_tests << "\n";
-        std::cout << "Maximum error:        " << std::scientific << max_error << "\n";
-        std::cout << "Success rate:         " << (100.0 * passed_tests / samples) << "%\n";
-        std::cout << "Computation time:     " << std::fixed << duration.count() << "s\n\n";
+        std::cout << "Maximum error:        " << std::scientific << std::setprecision(6) << max_error << "\n";
+        std::cout << "Success rate:         " << std::defaultfloat << (samples > 0 ? 100.0 * passed_tests / samples : 0) << "%\n";
+        std::cout << "Computation time:     " << std::fixed << duration.count() << "s\n";
+        std::cout << "Throughput:           " << std::setprecision(0) << samples / duration.count() << " samples/s\n\n";
 
         if (failed_tests == 0) {
             std::cout << "✓ PROOF STATUS: ALL TESTS PASSED - Euler's formula holds computationally\n";
@@ -304,6 +732,14 @@ int main(int argc, char** argv) {
                 };
                 std::cout << "Visualizing Riemann function 1/z at " << resolution << "x" << resolution << "\n";
                 visualizer.renderRiemannSurface(riemann_func, -2, 2, -2, 2, resolution);
+            } else if (func_type == "zeta") {
+                std::vector<complex_analysis::Complex> values(static_cast<size_t>(resolution) * resolution);
+                auto start = std::chrono::steady_clock::now();
+                complex_analysis::riemann_zeta_grid(-10, 10, -30, 30, resolution, resolution, values.data());
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                std::cout << "Visualizing Riemann zeta at " << resolution << "x" << resolution
+                          << " (evaluated in " << std::fixed << std::setprecision(3) << seconds << "s)\n";
+                visualizer.renderComplexGrid(values, -10, 10, -30, 30, resolution);
             }
             visualizer.show();
         }
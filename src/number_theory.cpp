@@ -1,5 +1,9 @@
 #include "number_theory.h"
 #include "rng.h"
+#include "scheduler.h"
+#include "thread_pool.h"
+#include "result_io.h"
+#include "result_sink.h"
 #include <algorithm>
 #include <queue>
 #include <chrono>
@@ -11,7 +15,8 @@
 #include <mutex>
 #include <atomic>
 #include <immintrin.h>
-#include <unordered_map>
+#include <condition_variable>
+#include <cmath>
 
 namespace number_theory {
 uint64_t mod_pow(uint64_t base, uint64_t exp, uint64_t mod) {
@@ -32,8 +37,6 @@ uint64_t mod_pow(uint64_t base, uint64_t exp, uint64_t mod) {
 }
 
 uint64_t mod_pow_montgomery(uint64_t base, uint64_t exp, const MontgomeryModulus& mont) {
-    if (exp == 0) return mont.to_montgomery(1);
-    
     uint64_t result = mont.to_montgomery(1);
     uint64_t base_mont = mont.to_montgomery(base);
     
@@ -51,22 +54,11 @@ MontgomeryModulus::MontgomeryModulus(uint64_t modulus) : n(modulus) {
     bits = 64 - __builtin_clzll(n);
     r = 1ULL << bits;
     
-    i128 old_r = r, r_val = n;
-    i128 old_s = 1, s = 0;
-    
-    while (r_val != 0) {
-        i128 quotient = old_r / r_val;
-        i128 temp = r_val;
-        r_val = old_r - quotient * r_val;
-        old_r = temp;
-        
-        temp = s;
-        s = old_s - quotient * s;
-        old_s = temp;
-    }
+    // Newton iteration for n^-1 mod 2^64; each step doubles the correct low bits.
+    uint64_t inv = n;
+    for (int i = 0; i < 5; ++i) inv *= 2 - n * inv;
     
-    i128 inv = old_s;
-    n_inv = (-inv) & ((1ULL << bits) - 1);
+    n_inv = (0 - inv) & ((1ULL << bits) - 1);
     r_squared = ((u128)r * r) % n;
 }
 
@@ -88,6 +80,283 @@ uint64_t MontgomeryModulus::from_montgomery(uint64_t x) const {
     return reduce(x);
 }
 
+namespace {
+
+constexpr size_t POW_BATCH_LANES = 16;
+
+// Montgomery arithmetic with R = 2^32 for odd n < 2^32, one modulus shared by
+// every lane. mul() uses the subtractive form (hi(t) - hi(m*n)) so the
+// intermediate never exceeds 64 bits.
+struct Montgomery32Lanes {
+    uint64_t n, n_inv, one;
+
+    explicit Montgomery32Lanes(uint64_t modulus) : n(modulus) {
+        uint32_t inv = static_cast<uint32_t>(modulus);
+        for (int i = 0; i < 4; ++i) inv *= 2 - static_cast<uint32_t>(modulus) * inv;
+        n_inv = inv;
+        one = (1ULL << 32) % modulus;
+    }
+
+    uint64_t mul(uint64_t a, uint64_t b) const {
+        uint64_t t = a * b;
+        uint64_t m = static_cast<uint32_t>(static_cast<uint32_t>(t) * n_inv);
+        uint64_t u = (t >> 32) - ((m * n) >> 32);
+        return static_cast<int64_t>(u) < 0 ? u + n : u;
+    }
+
+    uint64_t to_montgomery(uint64_t x) const { return (x % n << 32) % n; }
+};
+
+#if defined(__AVX512F__)
+// GCC 12 reports the undefined pass-through inside _mm512_mul_epu32 as
+// maybe-uninitialized once it is inlined here.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+inline __m512i mont_mul_512(__m512i a, __m512i b, __m512i n, __m512i n_inv) {
+    __m512i t = _mm512_mul_epu32(a, b);
+    __m512i m = _mm512_mul_epu32(t, n_inv);
+    __m512i mn = _mm512_mul_epu32(m, n);
+    __m512i u = _mm512_sub_epi64(_mm512_srli_epi64(t, 32), _mm512_srli_epi64(mn, 32));
+    __mmask8 negative = _mm512_cmplt_epi64_mask(u, _mm512_setzero_si512());
+    return _mm512_mask_add_epi64(u, negative, u, n);
+}
+
+void pow_lanes_simd(const Montgomery32Lanes& mont, uint64_t* x, uint64_t exp) {
+    const __m512i n = _mm512_set1_epi64(static_cast<long long>(mont.n));
+    const __m512i n_inv = _mm512_set1_epi64(static_cast<long long>(mont.n_inv));
+    __m512i base0 = _mm512_loadu_si512(x);
+    __m512i base1 = _mm512_loadu_si512(x + 8);
+    __m512i acc0 = _mm512_set1_epi64(static_cast<long long>(mont.one));
+    __m512i acc1 = acc0;
+    while (exp > 0) {
+        if (exp & 1) {
+            acc0 = mont_mul_512(acc0, base0, n, n_inv);
+            acc1 = mont_mul_512(acc1, base1, n, n_inv);
+        }
+        base0 = mont_mul_512(base0, base0, n, n_inv);
+        base1 = mont_mul_512(base1, base1, n, n_inv);
+        exp >>= 1;
+    }
+    _mm512_storeu_si512(x, acc0);
+    _mm512_storeu_si512(x + 8, acc1);
+}
+#pragma GCC diagnostic pop
+#elif defined(__AVX2__)
+inline __m256i mont_mul_256(__m256i a, __m256i b, __m256i n, __m256i n_inv) {
+    __m256i t = _mm256_mul_epu32(a, b);
+    __m256i m = _mm256_mul_epu32(t, n_inv);
+    __m256i mn = _mm256_mul_epu32(m, n);
+    __m256i u = _mm256_sub_epi64(_mm256_srli_epi64(t, 32), _mm256_srli_epi64(mn, 32));
+    __m256i negative = _mm256_cmpgt_epi64(_mm256_setzero_si256(), u);
+    return _mm256_add_epi64(u, _mm256_and_si256(negative, n));
+}
+
+void pow_lanes_simd(const Montgomery32Lanes& mont, uint64_t* x, uint64_t exp) {
+    const __m256i n = _mm256_set1_epi64x(static_cast<long long>(mont.n));
+    const __m256i n_inv = _mm256_set1_epi64x(static_cast<long long>(mont.n_inv));
+    __m256i base[4], acc[4];
+    for (int v = 0; v < 4; ++v) {
+        base[v] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + 4 * v));
+        acc[v] = _mm256_set1_epi64x(static_cast<long long>(mont.one));
+    }
+    while (exp > 0) {
+        if (exp & 1) {
+            for (int v = 0; v < 4; ++v) acc[v] = mont_mul_256(acc[v], base[v], n, n_inv);
+        }
+        for (int v = 0; v < 4; ++v) base[v] = mont_mul_256(base[v], base[v], n, n_inv);
+        exp >>= 1;
+    }
+    for (int v = 0; v < 4; ++v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(x + 4 * v), acc[v]);
+    }
+}
+#else
+void pow_lanes_simd(const Montgomery32Lanes& mont, uint64_t* x, uint64_t exp) {
+    uint64_t base[POW_BATCH_LANES], acc[POW_BATCH_LANES];
+    for (size_t i = 0; i < POW_BATCH_LANES; ++i) {
+        base[i] = x[i];
+        acc[i] = mont.one;
+    }
+    while (exp > 0) {
+        if (exp & 1) {
+            for (size_t i = 0; i < POW_BATCH_LANES; ++i) acc[i] = mont.mul(acc[i], base[i]);
+        }
+        for (size_t i = 0; i < POW_BATCH_LANES; ++i) base[i] = mont.mul(base[i], base[i]);
+        exp >>= 1;
+    }
+    for (size_t i = 0; i < POW_BATCH_LANES; ++i) x[i] = acc[i];
+}
+#endif
+
+constexpr uint64_t TRIAL_PRIMES[] = {3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+
+bool miller_rabin_witness(const Montgomery64& mont, uint64_t a, uint64_t d, int s) {
+    a %= mont.modulus();
+    if (a == 0) return true;
+
+    const uint64_t one = mont.one();
+    const uint64_t minus_one = mont.modulus() - one;
+
+    uint64_t x = mont.pow_montgomery(mont.to_montgomery(a), d);
+    if (x == one || x == minus_one) return true;
+
+    for (int i = 1; i < s; ++i) {
+        x = mont.multiply(x, x);
+        if (x == minus_one) return true;
+        if (x == one) return false;
+    }
+    return false;
+}
+
+}
+
+bool is_prime_u64(uint64_t n) {
+    if (n < 2) return false;
+    if (n % 2 == 0) return n == 2;
+
+    for (uint64_t p : TRIAL_PRIMES) {
+        if (n % p == 0) return n == p;
+    }
+    if (n < 59 * 59) return true;
+
+    uint64_t d = n - 1;
+    int s = __builtin_ctzll(d);
+    d >>= s;
+
+    Montgomery64 mont(n);
+
+    // Bases from Jaeschke (n < 2^32) and Sinclair (all of uint64_t).
+    if (n < (1ULL << 32)) {
+        for (uint64_t a : {2ULL, 7ULL, 61ULL}) {
+            if (!miller_rabin_witness(mont, a, d, s)) return false;
+        }
+        return true;
+    }
+
+    for (uint64_t a : {2ULL, 325ULL, 9375ULL, 28178ULL, 450775ULL, 9780504ULL, 1795265022ULL}) {
+        if (!miller_rabin_witness(mont, a, d, s)) return false;
+    }
+    return true;
+}
+
+namespace {
+
+void pow_odd_batch(const Montgomery64& odd, const uint64_t* bases, size_t count, uint64_t exp, uint64_t* out) {
+    const uint64_t n = odd.modulus();
+
+    if (n < (1ULL << 32)) {
+        Montgomery32Lanes lanes(n);
+        uint64_t x[POW_BATCH_LANES];
+        for (size_t i = 0; i < count; i += POW_BATCH_LANES) {
+            const size_t width = std::min(POW_BATCH_LANES, count - i);
+            for (size_t j = 0; j < POW_BATCH_LANES; ++j) {
+                x[j] = j < width ? lanes.to_montgomery(bases[i + j]) : lanes.one;
+            }
+            pow_lanes_simd(lanes, x, exp);
+            for (size_t j = 0; j < width; ++j) {
+                out[i + j] = lanes.mul(x[j], 1);
+            }
+        }
+        return;
+    }
+
+    // 64-bit odd moduli: shared ladder, interleaved for instruction-level parallelism.
+    constexpr size_t WIDE_LANES = 4;
+    for (size_t i = 0; i < count; i += WIDE_LANES) {
+        const size_t width = std::min(WIDE_LANES, count - i);
+        uint64_t base[WIDE_LANES], acc[WIDE_LANES];
+        for (size_t j = 0; j < WIDE_LANES; ++j) {
+            base[j] = odd.to_montgomery(j < width ? bases[i + j] : 1);
+            acc[j] = odd.one();
+        }
+        for (uint64_t e = exp; e > 0; e >>= 1) {
+            if (e & 1) {
+                for (size_t j = 0; j < WIDE_LANES; ++j) acc[j] = odd.multiply(acc[j], base[j]);
+            }
+            for (size_t j = 0; j < WIDE_LANES; ++j) base[j] = odd.multiply(base[j], base[j]);
+        }
+        for (size_t j = 0; j < width; ++j) out[i + j] = odd.from_montgomery(acc[j]);
+    }
+}
+
+uint64_t pow_mod_2k(uint64_t base, uint64_t exp, uint64_t mask) {
+    uint64_t result = 1;
+    while (exp > 0) {
+        if (exp & 1) result *= base;
+        base *= base;
+        exp >>= 1;
+    }
+    return result & mask;
+}
+
+}
+
+Montgomery64::Montgomery64(uint64_t odd_modulus) : n(odd_modulus) {
+    // Newton iteration for n^-1 mod 2^64; each step doubles the correct low bits.
+    uint64_t inv = n;
+    for (int i = 0; i < 5; ++i) inv *= 2 - n * inv;
+    n_inv = inv;
+    r_mod_n = (0 - n) % n;
+    r2_mod_n = uint64_t((u128(r_mod_n) * r_mod_n) % n);
+}
+
+Montgomery64::Montgomery64(uint64_t odd_modulus, uint64_t inverse, uint64_t r_squared)
+    : n(odd_modulus), n_inv(inverse), r_mod_n(0), r2_mod_n(r_squared) {
+    r_mod_n = reduce(r2_mod_n);
+}
+
+uint64_t Montgomery64::pow_montgomery(uint64_t base_mont, uint64_t exp) const {
+    uint64_t result = r_mod_n;
+    while (exp > 0) {
+        if (exp & 1) result = multiply(result, base_mont);
+        base_mont = multiply(base_mont, base_mont);
+        exp >>= 1;
+    }
+    return result;
+}
+
+MontgomeryContext::MontgomeryContext(uint64_t modulus)
+    : n(modulus), twos(modulus ? __builtin_ctzll(modulus) : 0), odd(modulus >> twos) {
+    two_mask = (1ULL << twos) - 1;
+    
+    uint64_t inv = odd.modulus();
+    for (int i = 0; i < 5; ++i) inv *= 2 - odd.modulus() * inv;
+    odd_inv_mod_2k = inv & two_mask;
+}
+
+MontgomeryContext::MontgomeryContext(uint64_t modulus, const Montgomery64& odd_part)
+    : n(modulus), twos(modulus ? __builtin_ctzll(modulus) : 0), odd(odd_part) {
+    two_mask = (1ULL << twos) - 1;
+    odd_inv_mod_2k = odd.inverse() & two_mask;
+}
+
+uint64_t MontgomeryContext::combine(uint64_t odd_residue, uint64_t two_residue) const {
+    if (twos == 0) return odd_residue;
+    uint64_t t = ((two_residue - odd_residue) * odd_inv_mod_2k) & two_mask;
+    return odd_residue + odd.modulus() * t;
+}
+
+uint64_t MontgomeryContext::pow(uint64_t base, uint64_t exp) const {
+    uint64_t odd_residue = odd.pow(base, exp);
+    if (twos == 0) return odd_residue;
+    return combine(odd_residue, pow_mod_2k(base, exp, two_mask));
+}
+
+uint64_t mod_pow_montgomery(uint64_t base, uint64_t exp, const MontgomeryContext& ctx) {
+    return ctx.pow(base, exp);
+}
+
+void mod_pow_montgomery_batch(const uint64_t* bases, size_t count, uint64_t exp,
+                              const MontgomeryContext& ctx, uint64_t* out) {
+    pow_odd_batch(ctx.odd_part(), bases, count, exp, out);
+    if (ctx.two_power() == 0) return;
+    
+    const uint64_t mask = (1ULL << ctx.two_power()) - 1;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = ctx.combine(out[i], pow_mod_2k(bases[i], exp, mask));
+    }
+}
+
 bool is_prime_miller_rabin(uint64_t n, size_t rounds) {
     if (n < 2) return false;
     if (n == 2 || n == 3) return true;
@@ -100,7 +369,7 @@ bool is_prime_miller_rabin(uint64_t n, size_t rounds) {
         r++;
     }
     
-    SecureRNG rng;
+    static thread_local StreamRNG rng;
     
     for (size_t i = 0; i < rounds; i++) {
         uint64_t a = rng.uniform(static_cast<uint64_t>(2), n - 2);
@@ -122,11 +391,80 @@ bool is_prime_miller_rabin(uint64_t n, size_t rounds) {
     return true;
 }
 
+namespace {
+
+uint64_t binary_gcd(uint64_t a, uint64_t b) {
+    if (a == 0) return b;
+    if (b == 0) return a;
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    do {
+        b >>= __builtin_ctzll(b);
+        if (a > b) std::swap(a, b);
+        b -= a;
+    } while (b != 0);
+    return a << shift;
+}
+
+// One Brent run of x -> x^2 + c on odd composite n, entirely in Montgomery
+// form. The |x - y| differences of a block are multiplied together and the
+// GCD is taken once per block; a block that collapses to n is replayed one
+// step at a time to recover the factor.
+uint64_t brent_rho(const Montgomery64& mont, uint64_t c, uint64_t x0) {
+    constexpr uint64_t BLOCK = 128;
+    const uint64_t n = mont.modulus();
+    const uint64_t c_mont = mont.to_montgomery(c);
+
+    auto add_mod = [n](uint64_t a, uint64_t b) { return a >= n - b ? a - (n - b) : a + b; };
+    auto f = [&](uint64_t v) { return add_mod(mont.multiply(v, v), c_mont); };
+
+    uint64_t y = mont.to_montgomery(x0), x = y, ys = y;
+    uint64_t q = mont.one(), g = 1;
+
+    for (uint64_t r = 1; g == 1 && r <= config::POLLARD_RHO_MAX_ITER; r <<= 1) {
+        x = y;
+        for (uint64_t i = 0; i < r; ++i) y = f(y);
+
+        for (uint64_t k = 0; k < r && g == 1; k += BLOCK) {
+            ys = y;
+            const uint64_t steps = std::min(BLOCK, r - k);
+            for (uint64_t i = 0; i < steps; ++i) {
+                y = f(y);
+                q = mont.multiply(q, x > y ? x - y : y - x);
+            }
+            g = binary_gcd(q, n);
+        }
+    }
+
+    if (g == n) {
+        do {
+            ys = f(ys);
+            g = binary_gcd(x > ys ? x - ys : ys - x, n);
+        } while (g == 1);
+    }
+    return g;
+}
+
+}
+
 uint64_t pollard_rho_factor(uint64_t n) {
     if (n % 2 == 0) return 2;
-    if (is_prime_miller_rabin(n, config::MILLER_RABIN_ROUNDS)) return n;
+    if (is_prime_u64(n)) return n;
     
-    SecureRNG rng;
+    Montgomery64 mont(n);
+    
+    for (uint64_t c = 1; c <= 10; ++c) {
+        uint64_t d = brent_rho(mont, c, 2);
+        if (d != 1 && d != n) return d;
+    }
+    return n;
+}
+
+uint64_t pollard_rho_floyd(uint64_t n) {
+    if (n % 2 == 0) return 2;
+    if (is_prime_u64(n)) return n;
+    
+    StreamRNG rng;
     
     for (int attempt = 0; attempt < 10; attempt++) {
         uint64_t x = rng.uniform(static_cast<uint64_t>(2), n - 1);
@@ -155,6 +493,14 @@ std::map<uint64_t, int> factorize_advanced(uint64_t n) {
     std::map<uint64_t, int> factors;
     if (n <= 1) return factors;
     
+    if (const SpfTable* spf = installed_spf_table(); spf && spf->covers(n)) {
+        uint64_t primes[SpfTable::MAX_DISTINCT_PRIMES];
+        int exponents[SpfTable::MAX_DISTINCT_PRIMES];
+        const size_t count = spf->factor(n, primes, exponents);
+        for (size_t i = 0; i < count; ++i) factors.emplace_hint(factors.end(), primes[i], exponents[i]);
+        return factors;
+    }
+    
     std::vector<uint64_t> small_primes = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47};
     for (uint64_t p : small_primes) {
         if (n % p == 0) {
@@ -175,7 +521,7 @@ std::map<uint64_t, int> factorize_advanced(uint64_t n) {
         to_factor.pop();
         
         if (current == 1) continue;
-        if (is_prime_miller_rabin(current, config::MILLER_RABIN_ROUNDS)) {
+        if (is_prime_u64(current)) {
             factors[current]++;
             continue;
         }
@@ -206,14 +552,23 @@ uint64_t euler_phi(uint64_t n) {
     if (n == 1) return 1;
     if (n == 2) return 1;
     
-    static thread_local std::map<uint64_t, uint64_t> phi_cache;
-    
-    auto it = phi_cache.find(n);
-    if (it != phi_cache.end()) {
-        return it->second;
+    if (const SpfTable* spf = installed_spf_table(); spf && spf->covers(n)) {
+        uint64_t primes[SpfTable::MAX_DISTINCT_PRIMES];
+        int exponents[SpfTable::MAX_DISTINCT_PRIMES];
+        const size_t count = spf->factor(n, primes, exponents);
+        uint64_t result = n;
+        for (size_t i = 0; i < count; ++i) result = result / primes[i] * (primes[i] - 1);
+        return result;
     }
     
+    // Trial division wins below 2^24; above it, Brent rho is far cheaper
+    // than dividing up to sqrt(n).
     uint64_t result = n;
+    if (n >= (uint64_t(1) << 24)) {
+        for (const auto& [p, k] : factorize_advanced(n)) result = result / p * (p - 1);
+        return result;
+    }
+    
     uint64_t temp_n = n;
     
     if (temp_n % 2 == 0) {
@@ -232,215 +587,709 @@ uint64_t euler_phi(uint64_t n) {
         result = result / temp_n * (temp_n - 1);
     }
     
-    phi_cache[n] = result;
     return result;
 }
 
+namespace {
+
+uint64_t lambda_prime_power(uint64_t p, int k) {
+    if (p == 2 && k >= 3) return 1ULL << (k - 2);
+    uint64_t lambda_pk = p - 1;
+    for (int i = 1; i < k; i++) lambda_pk *= p;
+    return lambda_pk;
+}
+
+uint64_t lambda_from_factors(const std::map<uint64_t, int>& factors) {
+    uint64_t lambda = 1;
+    for (auto [p, k] : factors) lambda = std::lcm(lambda, lambda_prime_power(p, k));
+    return lambda;
+}
+
+}
+
 uint64_t carmichael_lambda(uint64_t n) {
     if (n <= 1) return n;
     if (n == 2) return 1;
     if (n == 4) return 2;
     
-    auto factors = factorize_advanced(n);
-    uint64_t lambda = 1;
+    if (const SpfTable* spf = installed_spf_table(); spf && spf->covers(n)) {
+        uint64_t primes[SpfTable::MAX_DISTINCT_PRIMES];
+        int exponents[SpfTable::MAX_DISTINCT_PRIMES];
+        const size_t count = spf->factor(n, primes, exponents);
+        uint64_t lambda = 1;
+        for (size_t i = 0; i < count; ++i) lambda = std::lcm(lambda, lambda_prime_power(primes[i], exponents[i]));
+        return lambda;
+    }
     
-    for (auto [p, k] : factors) {
-        uint64_t lambda_pk;
-        if (p == 2 && k >= 3) {
-            lambda_pk = 1ULL << (k - 2);
-        } else {
-            lambda_pk = (p - 1);
-            for (int i = 1; i < k; i++) lambda_pk *= p;
+    return lambda_from_factors(factorize_advanced(n));
+}
+
+std::vector<uint64_t> build_totient_table(uint64_t max_n) {
+    std::vector<uint64_t> phi(max_n + 1, 0);
+    if (max_n >= 1) phi[1] = 1;
+    
+    // Linear sieve: every composite is written exactly once, from its
+    // smallest prime factor, so the whole table costs O(max_n).
+    std::vector<uint64_t> primes;
+    for (uint64_t i = 2; i <= max_n; ++i) {
+        if (phi[i] == 0) {
+            phi[i] = i - 1;
+            primes.push_back(i);
+        }
+        for (uint64_t p : primes) {
+            if (p > max_n / i) break;
+            if (i % p == 0) {
+                phi[i * p] = phi[i] * p;
+                break;
+            }
+            phi[i * p] = phi[i] * (p - 1);
         }
-        lambda = std::lcm(lambda, lambda_pk);
     }
+    return phi;
+}
+
+void ModulusTable::reset(uint64_t first_n, uint64_t last_n, bool with_factors) {
+    first = first_n;
+    const size_t count = last_n > first_n ? last_n - first_n : 0;
+    phi.resize(count);
+    small_primes.resize(with_factors ? count * FACTOR_SLOTS : 0);
+    small_prime_count.resize(with_factors ? count : 0);
+    mont_inverse.resize(count);
+    mont_r_squared.resize(count);
+}
+
+void ModulusTable::fill(uint64_t from, uint64_t to, const std::vector<uint64_t>& sieving_primes) {
+    if (from >= to) return;
+    const size_t base = from - first;
+    const size_t len = to - from;
     
-    return lambda;
+    // Segmented multiplicative sieve: strip every sieving prime from its
+    // multiples; whatever is left above 1 is the single large prime factor.
+    const bool factors = !small_prime_count.empty();
+    std::vector<uint64_t> rest(len);
+    for (size_t i = 0; i < len; ++i) {
+        const uint64_t n = from + i;
+        rest[i] = n;
+        phi[base + i] = n;
+    }
+    if (factors) std::fill(small_prime_count.begin() + base, small_prime_count.begin() + base + len, 0);
+    
+    for (uint64_t p : sieving_primes) {
+        if (p > (to - 1) / p) break;
+        for (uint64_t n = (from + p - 1) / p * p; n < to; n += p) {
+            const size_t i = n - from;
+            rest[i] /= p;
+            while (rest[i] % p == 0) rest[i] /= p;
+            phi[base + i] = phi[base + i] / p * (p - 1);
+            if (factors) {
+                small_primes[(base + i) * FACTOR_SLOTS + small_prime_count[base + i]++] = static_cast<uint32_t>(p);
+            }
+        }
+    }
+    
+    for (size_t i = 0; i < len; ++i) {
+        const uint64_t q = rest[i];
+        if (q > 1) phi[base + i] = phi[base + i] / q * (q - 1);
+        
+        const uint64_t n = from + i;
+        Montgomery64 odd(n >> __builtin_ctzll(n));
+        mont_inverse[base + i] = odd.inverse();
+        mont_r_squared[base + i] = odd.r_squared();
+    }
+}
+
+MontgomeryContext ModulusTable::context(uint64_t n) const {
+    const size_t i = n - first;
+    return MontgomeryContext(n, Montgomery64(n >> __builtin_ctzll(n), mont_inverse[i], mont_r_squared[i]));
+}
+
+UnitSampler ModulusTable::sampler(uint64_t n) const {
+    const size_t i = n - first;
+    return UnitSampler(n, small_primes.data() + i * FACTOR_SLOTS, small_prime_count[i]);
+}
+
+namespace {
+
+uint64_t isqrt(uint64_t n) {
+    uint64_t r = static_cast<uint64_t>(std::sqrt(static_cast<double>(n)));
+    while (r > 0 && r * r > n) --r;
+    while ((r + 1) * (r + 1) <= n) ++r;
+    return r;
+}
+
+std::vector<uint64_t> sieving_primes_for(uint64_t max_n) {
+    return SegmentedSieve(1).primes(2, isqrt(max_n) + 1);
 }
 
-EulerTestResult stress_test_euler_theorem(uint64_t max_n, size_t tests_per_n, size_t max_counterexamples) {
+class ThreadBarrier {
+    std::mutex mtx;
+    std::condition_variable cv;
+    size_t count, waiting = 0, generation = 0;
+    
+public:
+    explicit ThreadBarrier(size_t threads) : count(threads) {}
+    
+    void arrive_and_wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        const size_t gen = generation;
+        if (++waiting == count) {
+            waiting = 0;
+            ++generation;
+            cv.notify_all();
+        } else {
+            cv.wait(lock, [&] { return gen != generation; });
+        }
+    }
+};
+
+}
+
+ModulusTable build_modulus_table(uint64_t first_n, uint64_t last_n, bool with_factors) {
+    ModulusTable table;
+    table.reset(first_n, last_n, with_factors);
+    if (last_n > first_n) table.fill(first_n, last_n, sieving_primes_for(last_n - 1));
+    return table;
+}
+
+EulerTestResult stress_test_euler_theorem(uint64_t max_n, size_t tests_per_n, size_t max_counterexamples,
+                                          const StressTestConfig& config) {
     EulerTestResult result;
     auto start_time = std::chrono::high_resolution_clock::now();
     
-    const size_t num_threads = std::min(static_cast<size_t>(std::thread::hardware_concurrency()), static_cast<size_t>(8));
-    const size_t chunk_size = std::max(static_cast<size_t>(1), (max_n - 1) / num_threads);
+    std::vector<uint64_t> phi_table;
+    if (config.use_totient_table) phi_table = build_totient_table(max_n);
+    
+    size_t num_threads = config.num_threads;
+    if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+    
+    // Cost per n grows with n, so a static split leaves the low-n threads idle.
+    // The scheduler hands out shrinking chunks and lets idle threads steal.
+    parallel::WorkStealingScheduler scheduler(2, max_n + 1, num_threads, 16);
     
-    std::vector<std::thread> threads;
     std::mutex result_mutex;
-    std::atomic<size_t> total_tests{0}, passed_tests{0}, skipped_tests{0};
+    std::atomic<size_t> total_tests{0}, passed_tests{0}, skipped_tests{0}, sampled_tests{0};
+    std::atomic<size_t> counterexample_budget{max_counterexamples};
     std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> counterexamples;
     
+    struct alignas(64) WorkerState {
+        std::vector<uint64_t> bases, powers;
+        // Factorisations of the current chunk, for the unit sampler.
+        ModulusTable table;
+        ResultWriter writer;
+        explicit WorkerState(ResultSink* sink) : writer(sink) {}
+    };
+    std::vector<std::unique_ptr<WorkerState>> workers;
+    std::vector<uint64_t> sieving_primes;
+    if (config.use_unit_sampler) sieving_primes = sieving_primes_for(max_n);
     for (size_t thread_id = 0; thread_id < num_threads; ++thread_id) {
-        threads.emplace_back([&, thread_id]() {
-            SecureRNG rng(thread_id + 1);
-            std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> local_counterexamples;
+        workers.emplace_back(new WorkerState(config.sink));
+        workers.back()->bases.reserve(tests_per_n);
+        workers.back()->powers.resize(tests_per_n);
+    }
+    
+    auto stats = scheduler.run([&](size_t thread_id, uint64_t start_n, uint64_t end_n) {
+        WorkerState& w = *workers[thread_id];
+        std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> local_counterexamples;
+        size_t local_total = 0, local_passed = 0, local_skipped = 0, local_sampled = 0;
+        if (config.use_unit_sampler) {
+            w.table.reset(start_n, end_n, true);
+            w.table.fill(start_n, end_n, sieving_primes);
+        }
+        
+        for (uint64_t n = start_n; n < end_n; ++n) {
+            if (n <= 2) {
+                local_skipped += tests_per_n;
+                if (config.record_moduli) w.writer.add({RecordKind::ModulusSummary, 0, n, 0, 1, tests_per_n});
+                continue;
+            }
+            MontgomeryContext mont(n);
             
-            uint64_t start_n = 2 + thread_id * chunk_size;
-            uint64_t end_n = std::min(max_n + 1, start_n + chunk_size);
+            StreamRNG rng = StreamRNG::keyed(config.seed, n);
+            uint64_t phi_n;
+            w.bases.resize(tests_per_n);
+            if (config.use_unit_sampler) {
+                const UnitSampler sampler = w.table.sampler(n);
+                sampler.fill(rng, w.bases.data(), tests_per_n);
+                local_sampled += tests_per_n;
+                phi_n = sampler.phi();
+            } else {
+                rng.fill(w.bases.data(), tests_per_n, 2, n - 1);
+                w.bases.erase(std::remove_if(w.bases.begin(), w.bases.end(),
+                                             [n](uint64_t a) { return std::__gcd(a, n) != 1; }),
+                              w.bases.end());
+                local_skipped += tests_per_n - w.bases.size();
+                phi_n = phi_table.empty() ? euler_phi(n) : phi_table[n];
+            }
             
-            std::map<uint64_t, uint64_t> phi_cache;
+            local_total += w.bases.size();
+            mod_pow_montgomery_batch(w.bases.data(), w.bases.size(), phi_n, mont, w.powers.data());
             
-            for (uint64_t n = start_n; n < end_n; ++n) {
-                if (phi_cache.find(n) == phi_cache.end()) {
-                    phi_cache[n] = euler_phi(n);
+            size_t n_passed = 0;
+            for (size_t i = 0; i < w.bases.size(); ++i) {
+                if (w.powers[i] == 1) {
+                    n_passed++;
+                } else {
+                    if (w.writer.active()) w.writer.add({RecordKind::Counterexample, 1, n, w.bases[i], phi_n, w.powers[i]});
+                    size_t budget = counterexample_budget.load(std::memory_order_relaxed);
+                    while (budget > 0 && !counterexample_budget.compare_exchange_weak(budget, budget - 1)) {}
+                    if (budget > 0) local_counterexamples.emplace_back(w.bases[i], n, phi_n);
                 }
+            }
+            local_passed += n_passed;
+            if (config.record_moduli) {
+                w.writer.add({RecordKind::ModulusSummary, static_cast<uint32_t>(w.bases.size()), n, n_passed, phi_n,
+                              tests_per_n - w.bases.size()});
+            }
+        }
+        
+        total_tests += local_total;
+        passed_tests += local_passed;
+        skipped_tests += local_skipped;
+        sampled_tests += local_sampled;
+        if (!local_counterexamples.empty()) {
+            std::lock_guard<std::mutex> lock(result_mutex);
+            counterexamples.insert(counterexamples.end(), local_counterexamples.begin(), local_counterexamples.end());
+        }
+    });
+    
+    for (const auto& s : stats) {
+        result.thread_busy_seconds.push_back(s.busy_seconds);
+        result.thread_idle_seconds.push_back(s.idle_seconds);
+    }
+    for (auto& w : workers) w->writer.flush();
+    if (config.sink) config.sink->flush();
+    
+    result.total_tests = total_tests.load();
+    result.passed_tests = passed_tests.load();
+    result.skipped_tests = skipped_tests.load();
+    result.sampled_tests = sampled_tests.load();
+    result.counterexamples = std::move(counterexamples);
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    result.avg_computation_time = std::chrono::duration<double>(end_time - start_time).count();
+    
+    return result;
+}
+
+EulerTestResult batch_test_euler_theorem(uint64_t max_n, size_t tests_per_n, const BatchTestConfig& config) {
+    EulerTestResult result;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    if (max_n < 2) return result;
+    
+    size_t num_threads = config.num_threads;
+    if (num_threads == 0) {
+        num_threads = std::min(static_cast<size_t>(std::thread::hardware_concurrency()), static_cast<size_t>(16));
+    }
+    
+    if (config.first_n > max_n) return result;
+    const uint64_t total_range = max_n - std::max<uint64_t>(2, config.first_n) + 1;
+    const uint64_t batch_size = std::max<uint64_t>(1, std::min(config.batch_size, total_range / num_threads + 1));
+    
+    // A resumed run starts from the checkpoint's watermark and carries its
+    // counters; everything else is rebuilt.
+    const bool checkpointing = !config.checkpoint_path.empty();
+    Checkpoint resumed;
+    if (checkpointing && config.resume && load_checkpoint(config.checkpoint_path, resumed)) {
+        if (resumed.tests_per_n != tests_per_n || resumed.seed != config.seed || resumed.first_n != config.first_n ||
+            resumed.max_n != max_n || resumed.use_unit_sampler != config.use_unit_sampler) {
+            std::cerr << "Checkpoint " << config.checkpoint_path
+                      << " was written with different first_n, max_n, tests_per_n, seed or sampler; starting over\n";
+            resumed = Checkpoint();
+        }
+    }
+    // Records written after the checkpoint, or all of them when starting
+    // over, are dropped so every window reaches the sink once.
+    if (config.resume && config.sink && config.sink->records_written() != resumed.sink_records &&
+        !config.sink->rewind(resumed.sink_records)) {
+        std::cerr << "Cannot rewind the record sink; records after the checkpoint may repeat\n";
+    }
+    
+    std::mutex result_mutex;
+    std::atomic<size_t> total_tests{resumed.partial.total_tests}, passed_tests{resumed.partial.passed_tests},
+        skipped_tests{resumed.partial.skipped_tests}, sampled_tests{resumed.partial.sampled_tests};
+    std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> counterexamples = resumed.partial.counterexamples;
+    std::atomic<size_t> counterexample_budget{config.max_counterexamples -
+                                              std::min(config.max_counterexamples, counterexamples.size())};
+    const double resumed_seconds = resumed.partial.avg_computation_time;
+    
+    std::vector<uint64_t> phi_table;
+    if (config.use_totient_table) phi_table = build_totient_table(max_n);
+    
+    // The range is walked in windows. For each window every thread fills its
+    // slice of the shared table, then all threads pull batches from it.
+    const bool use_store = config.enable_caching;
+    const uint64_t window = batch_size * num_threads * 4;
+    std::vector<uint64_t> sieving_primes;
+    if (use_store) sieving_primes = sieving_primes_for(max_n);
+    
+    ModulusTable table;
+    ThreadBarrier barrier(num_threads);
+    std::atomic<uint64_t> current_batch{2};
+    const uint64_t first_n = std::max<uint64_t>(2, config.first_n);
+    uint64_t window_start = first_n, window_end = std::max(first_n, resumed.next_n);
+    auto last_checkpoint = start_time;
+    
+    // Only called by thread 0 between windows, when every n below next_n is
+    // done and all threads are parked at the barrier.
+    auto write_checkpoint = [&](uint64_t next_n) {
+        if (config.sink) config.sink->flush();
+        Checkpoint checkpoint;
+        checkpoint.first_n = config.first_n;
+        checkpoint.max_n = max_n;
+        checkpoint.tests_per_n = tests_per_n;
+        checkpoint.seed = config.seed;
+        checkpoint.next_n = next_n;
+        checkpoint.use_unit_sampler = config.use_unit_sampler;
+        checkpoint.sink_records = config.sink ? config.sink->records_written() : 0;
+        checkpoint.partial.total_tests = total_tests.load();
+        checkpoint.partial.passed_tests = passed_tests.load();
+        checkpoint.partial.skipped_tests = skipped_tests.load();
+        checkpoint.partial.sampled_tests = sampled_tests.load();
+        checkpoint.partial.counterexamples = counterexamples;
+        auto now = std::chrono::high_resolution_clock::now();
+        checkpoint.partial.avg_computation_time = resumed_seconds + std::chrono::duration<double>(now - start_time).count();
+        if (!save_checkpoint(config.checkpoint_path, checkpoint)) {
+            std::cerr << "Failed to write checkpoint " << config.checkpoint_path << "\n";
+        }
+        last_checkpoint = now;
+    };
+    
+    parallel::global_pool().run(num_threads, [&](size_t thread_id) {
+        std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> local_counterexamples;
+        ResultWriter writer(config.sink);
+        std::vector<uint64_t> bases, powers;
+        bases.reserve(tests_per_n);
+        powers.resize(tests_per_n);
+        
+        while (true) {
+            if (thread_id == 0) {
+                if (checkpointing && window_start < window_end &&
+                    std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - last_checkpoint).count() >=
+                        config.checkpoint_interval) {
+                    write_checkpoint(window_end);
+                }
+                window_start = window_end;
+                window_end = window_start <= max_n ? std::min(window_start + window, max_n + 1) : window_start;
+                current_batch = window_start;
+                if (use_store) table.reset(window_start, window_end, config.use_unit_sampler);
+            }
+            barrier.arrive_and_wait();
+            if (window_start >= window_end) break;
+            
+            if (use_store) {
+                const uint64_t slice = (window_end - window_start + num_threads - 1) / num_threads;
+                const uint64_t from = std::min(window_end, window_start + thread_id * slice);
+                table.fill(from, std::min(window_end, from + slice), sieving_primes);
+                barrier.arrive_and_wait();
+            }
+            
+            while (true) {
+                uint64_t batch_start = current_batch.fetch_add(batch_size);
+                if (batch_start >= window_end) break;
                 
-                MontgomeryModulus mont(n);
+                uint64_t batch_end = std::min(batch_start + batch_size, window_end);
+                size_t batch_total = 0, batch_passed = 0, batch_skipped = 0, batch_sampled = 0;
                 
-                for (size_t t = 0; t < tests_per_n; ++t) {
+                for (uint64_t n = batch_start; n < batch_end; ++n) {
                     if (n <= 2) {
-                        skipped_tests++;
+                        batch_skipped += tests_per_n;
+                        if (config.record_moduli) writer.add({RecordKind::ModulusSummary, 0, n, 0, 1, tests_per_n});
                         continue;
                     }
                     
-                    uint64_t a = rng.uniform(static_cast<uint64_t>(2), n - 1);
+                    StreamRNG rng = StreamRNG::keyed(config.seed, n);
+                    uint64_t phi_n;
+                    bases.resize(tests_per_n);
+                    if (config.use_unit_sampler) {
+                        const UnitSampler sampler = use_store ? table.sampler(n) : UnitSampler(n);
+                        sampler.fill(rng, bases.data(), tests_per_n);
+                        batch_sampled += tests_per_n;
+                        phi_n = sampler.phi();
+                    } else {
+                        rng.fill(bases.data(), tests_per_n, 2, n - 1);
+                        bases.erase(std::remove_if(bases.begin(), bases.end(),
+                                                   [n](uint64_t a) { return std::__gcd(a, n) != 1; }),
+                                    bases.end());
+                        batch_skipped += tests_per_n - bases.size();
+                        
+                        if (!phi_table.empty()) {
+                            phi_n = phi_table[n];
+                        } else {
+                            phi_n = use_store ? table.phi[n - table.first] : euler_phi(n);
+                        }
+                    }
                     
-                    if (std::__gcd(a, n) != 1) {
-                        skipped_tests++;
+                    if (bases.empty()) {
+                        if (config.record_moduli) writer.add({RecordKind::ModulusSummary, 0, n, 0, phi_n, tests_per_n});
                         continue;
                     }
+                    batch_total += bases.size();
                     
-                    total_tests++;
-                    
-                    uint64_t phi_n = phi_cache[n];
-                    uint64_t result_val = mod_pow_montgomery(a, phi_n, mont);
-                    
-                    if (result_val == 1) {
-                        passed_tests++;
+                    if (config.use_montgomery) {
+                        const MontgomeryContext mont = use_store ? table.context(n) : MontgomeryContext(n);
+                        mod_pow_montgomery_batch(bases.data(), bases.size(), phi_n, mont, powers.data());
                     } else {
-                        if (local_counterexamples.size() < max_counterexamples / num_threads) {
-                            local_counterexamples.emplace_back(a, n, phi_n);
+                        for (size_t i = 0; i < bases.size(); ++i) powers[i] = mod_pow(bases[i], phi_n, n);
+                    }
+                    
+                    size_t n_passed = 0;
+                    for (size_t i = 0; i < bases.size(); ++i) {
+                        if (powers[i] == 1) {
+                            n_passed++;
+                        } else {
+                            if (writer.active()) writer.add({RecordKind::Counterexample, 1, n, bases[i], phi_n, powers[i]});
+                            size_t budget = counterexample_budget.load(std::memory_order_relaxed);
+                            while (budget > 0 && !counterexample_budget.compare_exchange_weak(budget, budget - 1)) {}
+                            if (budget > 0) local_counterexamples.emplace_back(bases[i], n, phi_n);
                         }
                     }
+                    batch_passed += n_passed;
+                    if (config.record_moduli) {
+                        writer.add({RecordKind::ModulusSummary, static_cast<uint32_t>(bases.size()), n, n_passed, phi_n,
+                                    tests_per_n - bases.size()});
+                    }
                 }
+                
+                total_tests += batch_total;
+                passed_tests += batch_passed;
+                skipped_tests += batch_skipped;
+                sampled_tests += batch_sampled;
             }
             
-            std::lock_guard<std::mutex> lock(result_mutex);
-            counterexamples.insert(counterexamples.end(), local_counterexamples.begin(), local_counterexamples.end());
-        });
-    }
+            // Publish this window's counterexamples and records so a
+            // checkpoint taken after the barrier covers them.
+            writer.flush();
+            if (!local_counterexamples.empty()) {
+                std::lock_guard<std::mutex> lock(result_mutex);
+                counterexamples.insert(counterexamples.end(), local_counterexamples.begin(), local_counterexamples.end());
+                local_counterexamples.clear();
+            }
+            barrier.arrive_and_wait();
+        }
+    });
     
-    for (auto& thread : threads) {
-        thread.join();
-    }
+    if (config.sink) config.sink->flush();
+    if (checkpointing) write_checkpoint(std::max(window_end, max_n + 1));
     
     result.total_tests = total_tests.load();
     result.passed_tests = passed_tests.load();
     result.skipped_tests = skipped_tests.load();
+    result.sampled_tests = sampled_tests.load();
     result.counterexamples = std::move(counterexamples);
     
     auto end_time = std::chrono::high_resolution_clock::now();
-    result.avg_computation_time = std::chrono::duration<double>(end_time - start_time).count();
+    result.avg_computation_time = resumed_seconds + std::chrono::duration<double>(end_time - start_time).count();
     
     return result;
 }
 
-#ifdef __AVX2__
-void simd_sieve_primes(std::vector<bool>& is_prime, uint64_t limit) {
-    if (limit < 2) return;
+namespace {
+
+// One cyclic factor of (Z/nZ)*: generator has the given order mod modulus,
+// where modulus is the prime power the factor comes from.
+struct CyclicFactor {
+    uint64_t modulus;
+    uint64_t generator;
+    uint64_t order;
+    // Distinct primes of order: those of p - 1, then p itself for k >= 2.
+    uint64_t order_primes[SpfTable::MAX_DISTINCT_PRIMES + 1];
+    size_t num_order_primes;
+};
+
+uint64_t inverse_mod(uint64_t a, uint64_t m) {
+    i128 old_r = a, r = m, old_s = 1, s = 0;
+    while (r != 0) {
+        i128 q = old_r / r;
+        i128 t = old_r - q * r; old_r = r; r = t;
+        t = old_s - q * s; old_s = s; s = t;
+    }
+    if (old_s < 0) old_s += m;
+    return static_cast<uint64_t>(old_s);
+}
+
+bool has_exact_order(const MontgomeryContext& ctx, uint64_t g, uint64_t order, const uint64_t* order_primes, size_t count) {
+    if (ctx.pow(g, order) != 1) return false;
+    for (size_t i = 0; i < count; ++i) {
+        if (ctx.pow(g, order / order_primes[i]) == 1) return false;
+    }
+    return true;
+}
+
+// Smallest primitive root mod the odd prime p; the distinct primes of
+// p - 1 go to p_minus_1_primes and their count is returned in count.
+uint64_t primitive_root(uint64_t p, const SpfTable& spf, uint64_t* p_minus_1_primes, size_t& count) {
+    int exponents[SpfTable::MAX_DISTINCT_PRIMES];
+    count = spf.factor(p - 1, p_minus_1_primes, exponents);
+    const MontgomeryContext mod_p(p);
+    uint64_t g = 2;
+    while (!has_exact_order(mod_p, g, p - 1, p_minus_1_primes, count)) g++;
+    return g;
+}
+
+// primitive_root for every odd prime below bound, computed once up front.
+// Primes below bound divide most n, so the searches they would repeat per
+// n are done once; larger primes are rare enough to search for each time.
+class PrimeRootCache {
+    std::vector<uint32_t> primes, roots, order_begin, order_primes;
     
-    is_prime.assign(limit + 1, true);
-    is_prime[0] = is_prime[1] = false;
+public:
+    static constexpr uint64_t BOUND = 1 << 20;
     
-    for (uint64_t i = 2; i * i <= limit; ++i) {
-        if (is_prime[i]) {
-            for (uint64_t j = i * i; j <= limit; j += i) {
-                is_prime[j] = false;
-            }
+    PrimeRootCache(uint64_t bound, const SpfTable& spf) {
+        order_begin.push_back(0);
+        for (uint64_t p : SegmentedSieve(1).primes(3, bound)) {
+            uint64_t divisors[SpfTable::MAX_DISTINCT_PRIMES];
+            size_t count;
+            primes.push_back(static_cast<uint32_t>(p));
+            roots.push_back(static_cast<uint32_t>(primitive_root(p, spf, divisors, count)));
+            order_primes.insert(order_primes.end(), divisors, divisors + count);
+            order_begin.push_back(static_cast<uint32_t>(order_primes.size()));
+        }
+    }
+    
+    uint64_t root(uint64_t p, const SpfTable& spf, uint64_t* p_minus_1_primes, size_t& count) const {
+        if (primes.empty() || p > primes.back()) return primitive_root(p, spf, p_minus_1_primes, count);
+        const size_t i = std::lower_bound(primes.begin(), primes.end(), p) - primes.begin();
+        count = order_begin[i + 1] - order_begin[i];
+        std::copy(order_primes.begin() + order_begin[i], order_primes.begin() + order_begin[i + 1], p_minus_1_primes);
+        return roots[i];
+    }
+};
+
+// Fills cyclic with the factors of (Z/nZ)* for n = prod primes[i]^exponents[i]
+// and returns how many were written.
+size_t unit_group_factors(const uint64_t* primes, const int* exponents, size_t num_primes, const SpfTable& spf,
+                          const PrimeRootCache& roots, CyclicFactor* cyclic) {
+    size_t count = 0;
+    for (size_t i = 0; i < num_primes; ++i) {
+        const uint64_t p = primes[i];
+        const int k = exponents[i];
+        uint64_t q = 1;
+        for (int j = 0; j < k; j++) q *= p;
+        
+        if (p == 2) {
+            // (Z/2Z)* is trivial, (Z/4Z)* = <-1>, (Z/2^kZ)* = <-1> x <5> for k >= 3.
+            if (k >= 2) cyclic[count++] = {q, q - 1, 2, {2}, 1};
+            if (k >= 3) cyclic[count++] = {q, 5, q / 4, {2}, 1};
+            continue;
+        }
+        
+        CyclicFactor& c = cyclic[count++];
+        c.modulus = q;
+        c.order = q / p * (p - 1);
+        c.generator = roots.root(p, spf, c.order_primes, c.num_order_primes);
+        if (k >= 2) {
+            // Move g to g + p when needed so that it also generates
+            // (Z/p^kZ)* for every k (g^(p-1) != 1 mod p^2).
+            if (MontgomeryContext(p * p).pow(c.generator, p - 1) == 1) c.generator += p;
+            c.order_primes[c.num_order_primes++] = p;
         }
     }
+    return count;
 }
-#endif
 
-EulerTestResult batch_test_euler_theorem(uint64_t max_n, size_t tests_per_n, const BatchTestConfig& config) {
+}
+
+EulerTestResult exhaustive_test_euler_theorem(uint64_t max_n, size_t num_threads, size_t max_counterexamples) {
     EulerTestResult result;
     auto start_time = std::chrono::high_resolution_clock::now();
+    if (max_n < 2) return result;
     
-    size_t num_threads = config.num_threads;
-    if (num_threads == 0) {
-        num_threads = std::min(static_cast<size_t>(std::thread::hardware_concurrency()), static_cast<size_t>(16));
+    if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+    
+    // Every n and every p - 1 is factored by lookup: use the installed
+    // table if it reaches max_n, otherwise build one for this run.
+    const SpfTable* spf = installed_spf_table();
+    SpfTable local_spf;
+    if (!spf || !spf->covers(max_n)) {
+        local_spf = SpfTable(max_n + 1, num_threads);
+        spf = &local_spf;
     }
+    const PrimeRootCache roots(std::min<uint64_t>(max_n + 1, PrimeRootCache::BOUND), *spf);
     
-    const uint64_t total_range = max_n - 1;
-    const uint64_t batch_size = std::min(config.batch_size, total_range / num_threads + 1);
+    parallel::WorkStealingScheduler scheduler(2, max_n + 1, num_threads, 64);
     
-    std::vector<std::thread> threads;
     std::mutex result_mutex;
-    std::atomic<size_t> total_tests{0}, passed_tests{0}, skipped_tests{0};
+    std::atomic<size_t> total_tests{0}, passed_tests{0};
+    std::atomic<uint64_t> verified_units{0};
+    std::atomic<size_t> counterexample_budget{max_counterexamples};
     std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> counterexamples;
     
-    std::atomic<uint64_t> current_batch{2};
-    
-    for (size_t thread_id = 0; thread_id < num_threads; ++thread_id) {
-        threads.emplace_back([&, thread_id]() {
-            SecureRNG rng(thread_id * 12345 + 67890);
-            std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> local_counterexamples;
+    auto stats = scheduler.run([&](size_t, uint64_t start_n, uint64_t end_n) {
+        std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> local_counterexamples;
+        size_t local_total = 0, local_passed = 0;
+        uint64_t local_units = 0;
+        uint64_t primes[SpfTable::MAX_DISTINCT_PRIMES];
+        int exponents[SpfTable::MAX_DISTINCT_PRIMES];
+        CyclicFactor cyclic[SpfTable::MAX_DISTINCT_PRIMES + 1];
+        
+        auto record_failure = [&](uint64_t a, uint64_t n, uint64_t phi_n) {
+            size_t budget = counterexample_budget.load(std::memory_order_relaxed);
+            while (budget > 0 && !counterexample_budget.compare_exchange_weak(budget, budget - 1)) {}
+            if (budget > 0) local_counterexamples.emplace_back(a, n, phi_n);
+        };
+        
+        for (uint64_t n = start_n; n < end_n; ++n) {
+            const size_t num_primes = spf->factor(n, primes, exponents);
+            uint64_t phi_n = n, expected_lambda = 1;
+            for (size_t i = 0; i < num_primes; ++i) {
+                phi_n = phi_n / primes[i] * (primes[i] - 1);
+                expected_lambda = std::lcm(expected_lambda, lambda_prime_power(primes[i], exponents[i]));
+            }
             
-            std::unordered_map<uint64_t, uint64_t> phi_cache;
-            std::unordered_map<uint64_t, std::unique_ptr<MontgomeryModulus>> mont_cache;
+            const size_t num_cyclic = unit_group_factors(primes, exponents, num_primes, *spf, roots, cyclic);
+            MontgomeryContext mont(n);
+            bool all_passed = true;
+            uint64_t group_order = 1, lambda = 1;
             
-            while (true) {
-                uint64_t batch_start = current_batch.fetch_add(batch_size);
-                if (batch_start > max_n) break;
+            for (size_t j = 0; j < num_cyclic; ++j) {
+                const CyclicFactor& c = cyclic[j];
+                local_total++;
+                group_order *= c.order;
+                lambda = std::lcm(lambda, c.order);
                 
-                uint64_t batch_end = std::min(batch_start + batch_size, max_n + 1);
+                // Lift the generator to n: g mod its prime power, 1 elsewhere.
+                uint64_t lifted = c.generator;
+                const uint64_t rest = n / c.modulus;
+                if (rest > 1) {
+                    const uint64_t t = static_cast<uint64_t>(static_cast<u128>(c.generator - 1) * inverse_mod(rest % c.modulus, c.modulus) % c.modulus);
+                    lifted = 1 + rest * t;
+                }
                 
-                for (uint64_t n = batch_start; n < batch_end; ++n) {
-                    if (config.enable_caching && phi_cache.find(n) == phi_cache.end()) {
-                        phi_cache[n] = euler_phi(n);
-                    }
-                    
-                    if (config.use_montgomery && mont_cache.find(n) == mont_cache.end()) {
-                        mont_cache[n] = std::make_unique<MontgomeryModulus>(n);
-                    }
-                    
-                    for (size_t t = 0; t < tests_per_n; ++t) {
-                        if (n <= 2) {
-                            skipped_tests++;
-                            continue;
-                        }
-                        
-                        uint64_t a = rng.uniform(static_cast<uint64_t>(2), n - 1);
-                        
-                        if (std::__gcd(a, n) != 1) {
-                            skipped_tests++;
-                            continue;
-                        }
-                        
-                        total_tests++;
-                        
-                        uint64_t phi_n = config.enable_caching ? phi_cache[n] : euler_phi(n);
-                        uint64_t result_val;
-                        
-                        if (config.use_montgomery && mont_cache[n]) {
-                            result_val = mod_pow_montgomery(a, phi_n, *mont_cache[n]);
-                        } else {
-                            result_val = mod_pow(a, phi_n, n);
-                        }
-                        
-                        if (result_val == 1) {
-                            passed_tests++;
-                        } else {
-                            if (local_counterexamples.size() < 100) {
-                                local_counterexamples.emplace_back(a, n, phi_n);
-                            }
-                        }
-                    }
+                if (has_exact_order(MontgomeryContext(c.modulus), c.generator, c.order, c.order_primes, c.num_order_primes) &&
+                    mont.pow(lifted, phi_n) == 1) {
+                    local_passed++;
+                } else {
+                    all_passed = false;
+                    record_failure(lifted, n, phi_n);
                 }
             }
             
+            // The certified orders must account for the whole group.
+            if (group_order != phi_n || lambda != expected_lambda) {
+                all_passed = false;
+                record_failure(0, n, phi_n);
+            }
+            if (all_passed) local_units += phi_n;
+        }
+        
+        total_tests += local_total;
+        passed_tests += local_passed;
+        verified_units += local_units;
+        if (!local_counterexamples.empty()) {
             std::lock_guard<std::mutex> lock(result_mutex);
             counterexamples.insert(counterexamples.end(), local_counterexamples.begin(), local_counterexamples.end());
-        });
-    }
+        }
+    });
     
-    for (auto& thread : threads) {
-        thread.join();
+    for (const auto& s : stats) {
+        result.thread_busy_seconds.push_back(s.busy_seconds);
+        result.thread_idle_seconds.push_back(s.idle_seconds);
     }
     
     result.total_tests = total_tests.load();
     result.passed_tests = passed_tests.load();
-    result.skipped_tests = skipped_tests.load();
+    result.verified_units = verified_units.load();
     result.counterexamples = std::move(counterexamples);
     
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -449,4 +1298,89 @@ EulerTestResult batch_test_euler_theorem(uint64_t max_n, size_t tests_per_n, con
     return result;
 }
 
+void UnitSampler::init(const uint64_t* primes, const int* exponents, size_t num_primes) {
+    count = num_primes;
+    phi_n = 1;
+    for (size_t i = 0; i < num_primes; ++i) {
+        const uint64_t p = primes[i];
+        uint64_t prime_power = p;
+        for (int e = 1; e < exponents[i]; ++e) prime_power *= p;
+        
+        const uint64_t rest = n / prime_power;
+        const uint64_t inverse = rest == 1 ? 1 : inverse_mod(rest % prime_power, prime_power);
+        components[i] = {p, prime_power / p * (p - 1), static_cast<uint64_t>(static_cast<u128>(rest) * inverse % n)};
+        phi_n *= components[i].units;
+    }
+}
+
+UnitSampler::UnitSampler(uint64_t modulus) : n(modulus) {
+    uint64_t primes[SpfTable::MAX_DISTINCT_PRIMES];
+    int exponents[SpfTable::MAX_DISTINCT_PRIMES];
+    size_t num_primes = 0;
+    if (const SpfTable* spf = installed_spf_table(); spf && spf->covers(n)) {
+        num_primes = spf->factor(n, primes, exponents);
+    } else {
+        for (auto [p, k] : factorize_advanced(n)) {
+            primes[num_primes] = p;
+            exponents[num_primes++] = k;
+        }
+    }
+    init(primes, exponents, num_primes);
+}
+
+UnitSampler::UnitSampler(uint64_t modulus, const std::map<uint64_t, int>& factors) : n(modulus) {
+    uint64_t primes[SpfTable::MAX_DISTINCT_PRIMES];
+    int exponents[SpfTable::MAX_DISTINCT_PRIMES];
+    size_t num_primes = 0;
+    for (auto [p, k] : factors) {
+        primes[num_primes] = p;
+        exponents[num_primes++] = k;
+    }
+    init(primes, exponents, num_primes);
+}
+
+UnitSampler::UnitSampler(uint64_t modulus, const uint32_t* small_primes, size_t num_small) : n(modulus) {
+    uint64_t primes[SpfTable::MAX_DISTINCT_PRIMES];
+    int exponents[SpfTable::MAX_DISTINCT_PRIMES];
+    size_t num_primes = 0;
+    uint64_t rest = n;
+    for (size_t i = 0; i < num_small; ++i) {
+        const uint64_t p = small_primes[i];
+        int k = 0;
+        while (rest % p == 0) {
+            rest /= p;
+            ++k;
+        }
+        primes[num_primes] = p;
+        exponents[num_primes++] = k;
+    }
+    if (rest > 1) {
+        primes[num_primes] = rest;
+        exponents[num_primes++] = 1;
+    }
+    init(primes, exponents, num_primes);
+}
+
+uint64_t UnitSampler::unit(uint64_t index) const {
+    if (count == 1) {
+        const uint64_t p = components[0].p;
+        return index / (p - 1) * p + index % (p - 1) + 1;
+    }
+    uint64_t x = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Component& c = components[i];
+        const uint64_t digit = index % c.units;
+        index /= c.units;
+        // The digit-th unit mod p^k: skip one multiple of p per p - 1 units.
+        const uint64_t local = digit / (c.p - 1) * c.p + digit % (c.p - 1) + 1;
+        x = static_cast<uint64_t>((static_cast<u128>(local) * c.crt_coeff + x) % n);
+    }
+    return x;
+}
+
+void UnitSampler::fill(StreamRNG& rng, uint64_t* out, size_t num_units) const {
+    rng.fill(out, num_units, 0, phi_n - 1);
+    for (size_t i = 0; i < num_units; ++i) out[i] = unit(out[i]);
+}
+
 }
@@ -0,0 +1,185 @@
+#include "pseudoprime.h"
+#include "number_theory.h"
+#include "result_sink.h"
+#include "scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <thread>
+
+namespace number_theory {
+
+namespace {
+
+// Integers per segment; only the odd half is stored.
+constexpr uint64_t SEGMENT_SPAN = 1 << 17;
+
+enum : uint8_t {
+    COMPOSITE = 1,
+    NOT_KORSELT = 2,
+};
+
+struct SegmentBuffers {
+    std::vector<uint64_t> rest;  // n with the sieved primes divided out
+    std::vector<uint8_t> flags;
+    std::vector<uint8_t> prime_count;
+    ResultWriter writer;
+    std::vector<uint64_t> fermat, euler;
+    uint64_t carmichael = 0, odd_numbers = 0;
+
+    SegmentBuffers(ResultSink* sink, size_t bases)
+        : rest(SEGMENT_SPAN / 2), flags(SEGMENT_SPAN / 2), prime_count(SEGMENT_SPAN / 2),
+          writer(sink), fermat(bases, 0), euler(bases, 0) {}
+};
+
+uint64_t isqrt(uint64_t n) {
+    uint64_t r = static_cast<uint64_t>(std::sqrt(static_cast<double>(n)));
+    while (r > 0 && r * r > n) --r;
+    while ((r + 1) * (r + 1) <= n) ++r;
+    return r;
+}
+
+void process_segment(uint64_t lo, uint64_t hi, const std::vector<uint64_t>& primes,
+                     const PseudoprimeConfig& config, SegmentBuffers& buf) {
+    const uint64_t first = lo | 1;
+    if (first >= hi) return;
+    const size_t count = static_cast<size_t>((hi - first + 1) / 2);
+    buf.odd_numbers += count;
+
+    for (size_t i = 0; i < count; ++i) {
+        buf.rest[i] = first + 2 * i;
+        buf.flags[i] = 0;
+        buf.prime_count[i] = 0;
+    }
+
+    const uint64_t limit = isqrt(hi - 1);
+    for (uint64_t p : primes) {
+        if (p > limit) break;
+        uint64_t m = (first + p - 1) / p * p;
+        if (m % 2 == 0) m += p;
+        for (size_t i = static_cast<size_t>((m - first) / 2); i < count; i += p) {
+            const uint64_t n = first + 2 * i;
+            if (n != p) buf.flags[i] |= COMPOSITE;
+            if (buf.flags[i] & NOT_KORSELT) continue;
+            buf.rest[i] /= p;
+            if (buf.rest[i] % p == 0 || (n - 1) % (p - 1) != 0) {
+                buf.flags[i] |= NOT_KORSELT;
+            } else {
+                buf.prime_count[i]++;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t n = first + 2 * i;
+        if (n < 3 || !(buf.flags[i] & COMPOSITE)) continue;
+
+        if (config.carmichael && !(buf.flags[i] & NOT_KORSELT)) {
+            // At most one prime above sqrt(hi) can remain.
+            const uint64_t q = buf.rest[i];
+            int factors = buf.prime_count[i];
+            bool korselt = true;
+            if (q > 1) {
+                korselt = (n - 1) % (q - 1) == 0;
+                factors++;
+            }
+            if (korselt && factors >= 2) {
+                buf.carmichael++;
+                if (buf.writer.active()) {
+                    buf.writer.add({RecordKind::Carmichael, static_cast<uint32_t>(factors), n, 0, euler_phi(n), 0});
+                }
+            }
+        }
+
+        if (!config.fermat && !config.euler) continue;
+        const Montgomery64 mont(n);
+        const uint64_t one = mont.one(), minus_one = n - one;
+        for (size_t b = 0; b < config.bases.size(); ++b) {
+            const uint64_t base = config.bases[b];
+            if (std::gcd(base, n) != 1) continue;
+            const uint64_t half = mont.pow_montgomery(mont.to_montgomery(base), (n - 1) / 2);
+            if (config.fermat && mont.multiply(half, half) == one) {
+                buf.fermat[b]++;
+                if (buf.writer.active()) buf.writer.add({RecordKind::FermatPseudoprime, 1, n, base, n - 1, 1});
+            }
+            if (config.euler && (half == one || half == minus_one)) {
+                const int symbol = jacobi_symbol(base, n);
+                if ((symbol == 1 && half == one) || (symbol == -1 && half == minus_one)) {
+                    buf.euler[b]++;
+                    if (buf.writer.active()) {
+                        buf.writer.add({RecordKind::EulerPseudoprime, 1, n, base, (n - 1) / 2, mont.from_montgomery(half)});
+                    }
+                }
+            }
+        }
+    }
+}
+
+}
+
+int jacobi_symbol(uint64_t a, uint64_t n) {
+    a %= n;
+    int result = 1;
+    while (a != 0) {
+        while (a % 2 == 0) {
+            a /= 2;
+            const uint64_t r = n % 8;
+            if (r == 3 || r == 5) result = -result;
+        }
+        std::swap(a, n);
+        if (a % 4 == 3 && n % 4 == 3) result = -result;
+        a %= n;
+    }
+    return n == 1 ? result : 0;
+}
+
+PseudoprimeResult enumerate_pseudoprimes(uint64_t lower, uint64_t upper, const PseudoprimeConfig& config) {
+    PseudoprimeResult result;
+    result.fermat.assign(config.bases.size(), 0);
+    result.euler.assign(config.bases.size(), 0);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    if (upper <= lower) return result;
+
+    std::vector<uint64_t> primes;
+    const uint64_t limit = isqrt(upper - 1);
+    if (limit >= 3) primes = SegmentedSieve(1).primes(3, limit + 1);
+
+    size_t num_threads = config.num_threads;
+    if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    const uint64_t first_segment = lower / SEGMENT_SPAN;
+    const uint64_t end_segment = (upper - 1) / SEGMENT_SPAN + 1;
+    parallel::WorkStealingScheduler scheduler(first_segment, end_segment, num_threads, 1);
+
+    std::vector<std::unique_ptr<SegmentBuffers>> buffers;
+    for (size_t t = 0; t < scheduler.workers(); ++t) {
+        buffers.emplace_back(new SegmentBuffers(config.sink, config.bases.size()));
+    }
+
+    scheduler.run([&](size_t worker, uint64_t segment_begin, uint64_t segment_end) {
+        for (uint64_t segment = segment_begin; segment < segment_end; ++segment) {
+            const uint64_t lo = std::max(lower, segment * SEGMENT_SPAN);
+            const uint64_t hi = std::min(upper, (segment + 1) * SEGMENT_SPAN);
+            process_segment(lo, hi, primes, config, *buffers[worker]);
+        }
+    });
+
+    for (auto& buf : buffers) {
+        buf->writer.flush();
+        result.odd_numbers += buf->odd_numbers;
+        result.carmichael += buf->carmichael;
+        for (size_t b = 0; b < config.bases.size(); ++b) {
+            result.fermat[b] += buf->fermat[b];
+            result.euler[b] += buf->euler[b];
+        }
+    }
+    if (config.sink) config.sink->flush();
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    result.computation_time = std::chrono::duration<double>(end_time - start_time).count();
+    return result;
+}
+
+}
@@ -0,0 +1,230 @@
+#include "result_io.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace number_theory {
+
+namespace {
+
+constexpr char CHECKPOINT_MAGIC[8] = {'E', 'U', 'L', 'C', 'K', 'P', 'T', '5'};
+constexpr char SHARD_MAGIC[8] = {'E', 'U', 'L', 'S', 'H', 'R', 'D', '3'};
+
+// Little-endian fixed-width fields; every value is stored as 8 bytes.
+class ByteWriter {
+    std::string bytes;
+
+public:
+    void put(uint64_t value) {
+        for (int i = 0; i < 8; ++i) bytes.push_back(static_cast<char>(value >> (8 * i)));
+    }
+    void put(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        put(bits);
+    }
+    const std::string& data() const { return bytes; }
+};
+
+class ByteReader {
+    const std::string& bytes;
+    size_t pos = 0;
+
+public:
+    explicit ByteReader(const std::string& data, size_t offset = 0) : bytes(data), pos(offset) {}
+
+    bool get(uint64_t& value) {
+        if (bytes.size() - pos < 8) return false;
+        value = 0;
+        for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[pos + i])) << (8 * i);
+        pos += 8;
+        return true;
+    }
+    bool get(double& value) {
+        uint64_t bits;
+        if (!get(bits)) return false;
+        std::memcpy(&value, &bits, sizeof value);
+        return true;
+    }
+    size_t remaining() const { return bytes.size() - pos; }
+};
+
+uint64_t fnv1a(const char* data, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void put_result(ByteWriter& out, const EulerTestResult& result) {
+    out.put(static_cast<uint64_t>(result.total_tests));
+    out.put(static_cast<uint64_t>(result.passed_tests));
+    out.put(static_cast<uint64_t>(result.skipped_tests));
+    out.put(static_cast<uint64_t>(result.sampled_tests));
+    out.put(result.verified_units);
+    out.put(result.avg_computation_time);
+    out.put(static_cast<uint64_t>(result.counterexamples.size()));
+    for (const auto& [a, n, phi] : result.counterexamples) {
+        out.put(a);
+        out.put(n);
+        out.put(phi);
+    }
+}
+
+bool get_result(ByteReader& in, EulerTestResult& result) {
+    uint64_t total, passed, skipped, sampled, count;
+    if (!in.get(total) || !in.get(passed) || !in.get(skipped) || !in.get(sampled) || !in.get(result.verified_units) ||
+        !in.get(result.avg_computation_time) || !in.get(count)) {
+        return false;
+    }
+    if (count > in.remaining() / 24) return false;
+    result.total_tests = total;
+    result.passed_tests = passed;
+    result.skipped_tests = skipped;
+    result.sampled_tests = sampled;
+    result.counterexamples.resize(count);
+    for (auto& [a, n, phi] : result.counterexamples) {
+        if (!in.get(a) || !in.get(n) || !in.get(phi)) return false;
+    }
+    return true;
+}
+
+// Payload framed by the magic and a trailing FNV-1a checksum of the payload.
+bool write_framed(const std::string& path, const char (&magic)[8], const std::string& payload) {
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        ByteWriter checksum;
+        checksum.put(fnv1a(payload.data(), payload.size()));
+        file.write(magic, sizeof magic);
+        file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        file.write(checksum.data().data(), 8);
+        file.flush();
+        if (!file) return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(tmp_path, path, error);
+    return !error;
+}
+
+bool read_framed(const std::string& path, const char (&magic)[8], std::string& payload) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() < sizeof magic + 8 || std::memcmp(bytes.data(), magic, sizeof magic) != 0) return false;
+
+    payload = bytes.substr(sizeof magic, bytes.size() - sizeof magic - 8);
+    ByteReader tail(bytes, bytes.size() - 8);
+    uint64_t checksum;
+    return tail.get(checksum) && checksum == fnv1a(payload.data(), payload.size());
+}
+
+}
+
+bool save_checkpoint(const std::string& path, const Checkpoint& checkpoint) {
+    ByteWriter out;
+    out.put(checkpoint.first_n);
+    out.put(checkpoint.max_n);
+    out.put(checkpoint.tests_per_n);
+    out.put(checkpoint.seed);
+    out.put(checkpoint.next_n);
+    out.put(static_cast<uint64_t>(checkpoint.use_unit_sampler));
+    out.put(checkpoint.sink_records);
+    put_result(out, checkpoint.partial);
+    return write_framed(path, CHECKPOINT_MAGIC, out.data());
+}
+
+bool load_checkpoint(const std::string& path, Checkpoint& checkpoint) {
+    std::string payload;
+    if (!read_framed(path, CHECKPOINT_MAGIC, payload)) return false;
+
+    ByteReader in(payload);
+    Checkpoint loaded;
+    uint64_t unit_sampler;
+    if (!in.get(loaded.first_n) || !in.get(loaded.max_n) || !in.get(loaded.tests_per_n) || !in.get(loaded.seed) || !in.get(loaded.next_n) ||
+        !in.get(unit_sampler) || !in.get(loaded.sink_records) || !get_result(in, loaded.partial) || in.remaining() != 0) {
+        return false;
+    }
+    loaded.use_unit_sampler = unit_sampler != 0;
+    checkpoint = std::move(loaded);
+    return true;
+}
+
+bool save_shard_result(const std::string& path, const ShardResult& shard) {
+    ByteWriter out;
+    out.put(shard.first_n);
+    out.put(shard.max_n);
+    out.put(shard.tests_per_n);
+    out.put(shard.seed);
+    out.put(static_cast<uint64_t>(shard.use_unit_sampler));
+    put_result(out, shard.result);
+    return write_framed(path, SHARD_MAGIC, out.data());
+}
+
+bool load_shard_result(const std::string& path, ShardResult& shard) {
+    std::string payload;
+    if (!read_framed(path, SHARD_MAGIC, payload)) return false;
+
+    ByteReader in(payload);
+    ShardResult loaded;
+    uint64_t unit_sampler;
+    if (!in.get(loaded.first_n) || !in.get(loaded.max_n) || !in.get(loaded.tests_per_n) || !in.get(loaded.seed) ||
+        !in.get(unit_sampler) || !get_result(in, loaded.result) || in.remaining() != 0) {
+        return false;
+    }
+    loaded.use_unit_sampler = unit_sampler != 0;
+    shard = std::move(loaded);
+    return true;
+}
+
+void merge_results(EulerTestResult& total, const EulerTestResult& part) {
+    total.total_tests += part.total_tests;
+    total.passed_tests += part.passed_tests;
+    total.skipped_tests += part.skipped_tests;
+    total.sampled_tests += part.sampled_tests;
+    total.verified_units += part.verified_units;
+    total.avg_computation_time += part.avg_computation_time;
+    total.counterexamples.insert(total.counterexamples.end(), part.counterexamples.begin(), part.counterexamples.end());
+    for (const auto& [n, count] : part.modulus_distribution) total.modulus_distribution[n] += count;
+}
+
+bool merge_shard_results(std::vector<ShardResult> shards, ShardResult& merged, std::string& error) {
+    if (shards.empty()) {
+        error = "no shards to merge";
+        return false;
+    }
+    std::sort(shards.begin(), shards.end(),
+              [](const ShardResult& a, const ShardResult& b) { return a.first_n < b.first_n; });
+
+    ShardResult total;
+    total.first_n = shards.front().first_n;
+    total.max_n = shards.front().first_n - 1;
+    total.tests_per_n = shards.front().tests_per_n;
+    total.seed = shards.front().seed;
+    total.use_unit_sampler = shards.front().use_unit_sampler;
+    for (const auto& shard : shards) {
+        if (shard.tests_per_n != total.tests_per_n || shard.seed != total.seed ||
+            shard.use_unit_sampler != total.use_unit_sampler) {
+            error = "shard [" + std::to_string(shard.first_n) + ", " + std::to_string(shard.max_n) +
+                    "] was run with different tests_per_n, seed or --unit-sampler";
+            return false;
+        }
+        if (shard.first_n != total.max_n + 1) {
+            error = shard.first_n <= total.max_n
+                        ? "shards overlap at n=" + std::to_string(shard.first_n)
+                        : "no shard covers [" + std::to_string(total.max_n + 1) + ", " + std::to_string(shard.first_n - 1) + "]";
+            return false;
+        }
+        total.max_n = shard.max_n;
+        merge_results(total.result, shard.result);
+    }
+    merged = std::move(total);
+    return true;
+}
+
+}
@@ -0,0 +1,86 @@
+#include "result_sink.h"
+#include <cstring>
+#include <filesystem>
+
+namespace number_theory {
+
+namespace {
+
+constexpr char RECORDS_MAGIC[8] = {'E', 'U', 'L', 'R', 'E', 'C', 'S', '1'};
+
+}
+
+FileResultSink::FileResultSink(const std::string& path, bool append) : path(path) {
+    if (append) {
+        file = std::fopen(path.c_str(), "ab");
+        if (file && std::fseek(file, 0, SEEK_END) == 0) {
+            const long size = std::ftell(file);
+            if (size == 0) std::fwrite(RECORDS_MAGIC, 1, sizeof RECORDS_MAGIC, file);
+            else if (size > static_cast<long>(sizeof RECORDS_MAGIC)) written = (size - sizeof RECORDS_MAGIC) / sizeof(ResultRecord);
+        }
+    } else {
+        file = std::fopen(path.c_str(), "wb");
+        if (file) std::fwrite(RECORDS_MAGIC, 1, sizeof RECORDS_MAGIC, file);
+    }
+}
+
+FileResultSink::~FileResultSink() {
+    if (file) std::fclose(file);
+}
+
+void FileResultSink::write(const ResultRecord* records, size_t count) {
+    if (!file) return;
+    std::lock_guard<std::mutex> lock(mtx);
+    written += std::fwrite(records, sizeof(ResultRecord), count, file);
+}
+
+void FileResultSink::flush() {
+    if (!file) return;
+    std::lock_guard<std::mutex> lock(mtx);
+    std::fflush(file);
+}
+
+uint64_t FileResultSink::records_written() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return written;
+}
+
+bool FileResultSink::rewind(uint64_t records) {
+    if (!file) return false;
+    std::lock_guard<std::mutex> lock(mtx);
+    if (records > written || std::fflush(file) != 0) return false;
+    std::error_code error;
+    std::filesystem::resize_file(path, sizeof RECORDS_MAGIC + records * sizeof(ResultRecord), error);
+    if (error) return false;
+    written = records;
+    return true;
+}
+
+void CallbackResultSink::write(const ResultRecord* records, size_t count) {
+    std::lock_guard<std::mutex> lock(mtx);
+    callback(records, count);
+}
+
+ResultReader::ResultReader(const std::string& path) : file(std::fopen(path.c_str(), "rb")) {
+    char magic[sizeof RECORDS_MAGIC];
+    if (file && (std::fread(magic, 1, sizeof magic, file) != sizeof magic ||
+                 std::memcmp(magic, RECORDS_MAGIC, sizeof magic) != 0)) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+ResultReader::~ResultReader() {
+    if (file) std::fclose(file);
+}
+
+bool ResultReader::next(ResultRecord& record) {
+    return read(&record, 1) == 1;
+}
+
+size_t ResultReader::read(ResultRecord* out, size_t max_count) {
+    if (!file) return 0;
+    return std::fread(out, sizeof(ResultRecord), max_count, file);
+}
+
+}
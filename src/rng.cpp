@@ -1,14 +1,22 @@
 #include "rng.h"
 #include <mutex>
+#include <immintrin.h>
+
+namespace {
+
+uint64_t splitmix(uint64_t& x) {
+    x += 0x9e3779b97f4a7c15;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+constexpr uint64_t JUMP[4] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+constexpr uint64_t LONG_JUMP[4] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635};
+
+}
 
 SecureRNG::SecureRNG(uint64_t seed) {
-    auto splitmix = [](uint64_t& x) {
-        x += 0x9e3779b97f4a7c15;
-        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
-        x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
-        return x ^ (x >> 31);
-    };
-    
     for (auto& s : state) s = splitmix(seed);
 }
 
@@ -27,3 +35,127 @@ uint64_t SecureRNG::next() {
     
     return result;
 }
+
+StreamRNG::StreamRNG(uint64_t seed) {
+    for (size_t i = 0; i < LANES; ++i) {
+        s0[i] = splitmix(seed);
+        s1[i] = splitmix(seed);
+        s2[i] = splitmix(seed);
+        s3[i] = splitmix(seed);
+    }
+}
+
+StreamRNG StreamRNG::stream(uint64_t seed, uint64_t index) {
+    StreamRNG rng(seed);
+    for (uint64_t i = 0; i < index; ++i) rng.jump();
+    return rng;
+}
+
+StreamRNG StreamRNG::keyed(uint64_t seed, uint64_t key) {
+    return StreamRNG(seed ^ splitmix(key));
+}
+
+void StreamRNG::apply_jump(const uint64_t (&polynomial)[4]) {
+    // Jumping every lane in lockstep only needs the lanes' own update, so
+    // this runs the reference algorithm on all of them at once.
+    uint64_t a0[LANES] = {}, a1[LANES] = {}, a2[LANES] = {}, a3[LANES] = {};
+    for (uint64_t word : polynomial) {
+        for (int b = 0; b < 64; ++b) {
+            if (word & (1ULL << b)) {
+                for (size_t i = 0; i < LANES; ++i) {
+                    a0[i] ^= s0[i];
+                    a1[i] ^= s1[i];
+                    a2[i] ^= s2[i];
+                    a3[i] ^= s3[i];
+                }
+            }
+            const size_t saved = lane;
+            for (size_t i = 0; i < LANES; ++i) next();
+            lane = saved;
+        }
+    }
+    for (size_t i = 0; i < LANES; ++i) {
+        s0[i] = a0[i];
+        s1[i] = a1[i];
+        s2[i] = a2[i];
+        s3[i] = a3[i];
+    }
+}
+
+void StreamRNG::jump() { apply_jump(JUMP); }
+
+void StreamRNG::long_jump() { apply_jump(LONG_JUMP); }
+
+void StreamRNG::fill(uint64_t* out, size_t count) {
+    size_t k = 0;
+    while (k < count && lane != 0) out[k++] = next();
+    
+    // Whole rounds: every lane steps once, in lane order, matching next().
+    // The lanes live in locals so the stores to out cannot alias them.
+    uint64_t a[LANES], b[LANES], c[LANES], d[LANES];
+    for (size_t i = 0; i < LANES; ++i) {
+        a[i] = s0[i]; b[i] = s1[i]; c[i] = s2[i]; d[i] = s3[i];
+    }
+#ifdef __AVX2__
+    static_assert(LANES == 4, "one ymm register per state word");
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+    __m256i vc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c));
+    __m256i vd = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d));
+    for (; k + LANES <= count; k += LANES) {
+        // x * 5 and x * 9 as shift-and-add; AVX2 has no 64-bit multiply.
+        __m256i r = _mm256_add_epi64(_mm256_slli_epi64(vb, 2), vb);
+        r = _mm256_or_si256(_mm256_slli_epi64(r, 7), _mm256_srli_epi64(r, 57));
+        r = _mm256_add_epi64(_mm256_slli_epi64(r, 3), r);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), r);
+        
+        const __m256i t = _mm256_slli_epi64(vb, 17);
+        vc = _mm256_xor_si256(vc, va);
+        vd = _mm256_xor_si256(vd, vb);
+        vb = _mm256_xor_si256(vb, vc);
+        va = _mm256_xor_si256(va, vd);
+        vc = _mm256_xor_si256(vc, t);
+        vd = _mm256_or_si256(_mm256_slli_epi64(vd, 45), _mm256_srli_epi64(vd, 19));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(a), va);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(b), vb);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(c), vc);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), vd);
+#else
+    for (; k + LANES <= count; k += LANES) {
+        for (size_t i = 0; i < LANES; ++i) {
+            out[k + i] = rotl(b[i] * 5, 7) * 9;
+            const uint64_t t = b[i] << 17;
+            c[i] ^= a[i];
+            d[i] ^= b[i];
+            b[i] ^= c[i];
+            a[i] ^= d[i];
+            c[i] ^= t;
+            d[i] = rotl(d[i], 45);
+        }
+    }
+#endif
+    for (size_t i = 0; i < LANES; ++i) {
+        s0[i] = a[i]; s1[i] = b[i]; s2[i] = c[i]; s3[i] = d[i];
+    }
+    
+    while (k < count) out[k++] = next();
+}
+
+void StreamRNG::fill(uint64_t* out, size_t count, uint64_t min_val, uint64_t max_val) {
+    const uint64_t span = max_val - min_val;
+    fill(out, count);
+    if (span == std::numeric_limits<uint64_t>::max()) return;
+    
+    const uint64_t range = span + 1;
+    for (size_t k = 0; k < count; ++k) {
+        __uint128_t m = static_cast<__uint128_t>(out[k]) * range;
+        if (static_cast<uint64_t>(m) < range) {
+            const uint64_t threshold = -range % range;
+            while (static_cast<uint64_t>(m) < threshold) {
+                m = static_cast<__uint128_t>(next()) * range;
+            }
+        }
+        out[k] = min_val + static_cast<uint64_t>(m >> 64);
+    }
+}
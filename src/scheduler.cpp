@@ -0,0 +1,97 @@
+#include "scheduler.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace parallel {
+
+WorkStealingScheduler::WorkStealingScheduler(uint64_t begin, uint64_t end, size_t workers, uint64_t min_chunk)
+    : ranges(new WorkerRange[std::max<size_t>(workers, 1)]),
+      num_workers(std::max<size_t>(workers, 1)),
+      min_chunk(std::max<uint64_t>(min_chunk, 1)) {
+    const uint64_t total = end > begin ? end - begin : 0;
+    for (size_t w = 0; w < num_workers; ++w) {
+        ranges[w].begin = begin + total * w / num_workers;
+        ranges[w].end = begin + total * (w + 1) / num_workers;
+    }
+}
+
+bool WorkStealingScheduler::steal(size_t thief) {
+    while (true) {
+        size_t victim = num_workers;
+        uint64_t most = 0;
+        for (size_t k = 1; k < num_workers; ++k) {
+            const size_t w = (thief + k) % num_workers;
+            std::lock_guard<std::mutex> lock(ranges[w].mtx);
+            const uint64_t remaining = ranges[w].end - ranges[w].begin;
+            if (remaining > most) {
+                most = remaining;
+                victim = w;
+            }
+        }
+        if (victim == num_workers) return false;
+
+        uint64_t taken_begin, taken_end;
+        {
+            std::lock_guard<std::mutex> lock(ranges[victim].mtx);
+            WorkerRange& v = ranges[victim];
+            if (v.begin == v.end) continue;
+            const uint64_t remaining = v.end - v.begin;
+            taken_end = v.end;
+            taken_begin = remaining <= min_chunk ? v.begin : v.begin + remaining / 2;
+            v.end = taken_begin;
+        }
+
+        std::lock_guard<std::mutex> lock(ranges[thief].mtx);
+        ranges[thief].begin = taken_begin;
+        ranges[thief].end = taken_end;
+        return true;
+    }
+}
+
+bool WorkStealingScheduler::next_chunk(size_t worker, uint64_t& chunk_begin, uint64_t& chunk_end, bool& stolen) {
+    stolen = false;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(ranges[worker].mtx);
+            WorkerRange& r = ranges[worker];
+            if (r.begin < r.end) {
+                const uint64_t remaining = r.end - r.begin;
+                const uint64_t chunk = std::min(remaining, std::max(min_chunk, remaining / 8));
+                chunk_begin = r.begin;
+                chunk_end = r.begin + chunk;
+                r.begin = chunk_end;
+                return true;
+            }
+        }
+        if (!steal(worker)) return false;
+        stolen = true;
+    }
+}
+
+std::vector<WorkerStats> WorkStealingScheduler::run(const std::function<void(size_t, uint64_t, uint64_t)>& fn) {
+    using clock = std::chrono::steady_clock;
+    std::vector<WorkerStats> stats(num_workers);
+    const auto start = clock::now();
+
+    auto work = [&](size_t worker) {
+        WorkerStats& s = stats[worker];
+        uint64_t chunk_begin, chunk_end;
+        bool stolen;
+        while (next_chunk(worker, chunk_begin, chunk_end, stolen)) {
+            const auto t0 = clock::now();
+            fn(worker, chunk_begin, chunk_end);
+            s.busy_seconds += std::chrono::duration<double>(clock::now() - t0).count();
+            s.chunks++;
+            if (stolen) s.steals++;
+        }
+    };
+
+    global_pool().run(num_workers, work);
+
+    const double wall = std::chrono::duration<double>(clock::now() - start).count();
+    for (auto& s : stats) s.idle_seconds = std::max(0.0, wall - s.busy_seconds);
+    return stats;
+}
+
+}
@@ -0,0 +1,464 @@
+#include "sieve.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+
+namespace number_theory {
+
+namespace {
+
+constexpr int8_t WHEEL30_INDEX[30] = {
+    -1, 0, -1, -1, -1, -1, -1, 1, -1, -1, -1, 2, -1, 3, -1,
+    -1, -1, 4, -1, 5, -1, -1, -1, 6, -1, -1, -1, -1, -1, 7
+};
+
+// Primes whose multiples are pre-removed by the repeating byte patterns.
+// 7*11*13*17 = 17017 bytes and 19*23*29*31 = 392863 bytes per period.
+constexpr uint32_t PATTERN_A_PRIMES[] = {7, 11, 13, 17};
+constexpr uint32_t PATTERN_B_PRIMES[] = {19, 23, 29, 31};
+constexpr uint32_t FIRST_SIEVING_PRIME = 37;
+
+struct SievePattern {
+    std::vector<uint8_t> bytes;
+
+    template<size_t N>
+    explicit SievePattern(const uint32_t (&primes)[N]) {
+        size_t period = 1;
+        for (uint32_t p : primes) period *= p;
+        bytes.assign(period, 0xFF);
+
+        for (size_t i = 0; i < period; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                uint64_t n = 30 * i + WHEEL30_RESIDUES[j];
+                for (uint32_t p : primes) {
+                    if (n % p == 0) {
+                        bytes[i] &= static_cast<uint8_t>(~(1u << j));
+                        break;
+                    }
+                }
+            }
+        }
+    }
+};
+
+const SievePattern& pattern_a() {
+    static const SievePattern pattern(PATTERN_A_PRIMES);
+    return pattern;
+}
+
+const SievePattern& pattern_b() {
+    static const SievePattern pattern(PATTERN_B_PRIMES);
+    return pattern;
+}
+
+void and_bytes(uint8_t* dst, const uint8_t* src, size_t len) {
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 32 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(a, b));
+    }
+#endif
+    for (; i < len; ++i) dst[i] &= src[i];
+}
+
+void copy_pattern(uint8_t* dst, size_t len, const SievePattern& pattern, uint64_t first_byte) {
+    const size_t period = pattern.bytes.size();
+    size_t offset = first_byte % period;
+    while (len > 0) {
+        size_t run = std::min(len, period - offset);
+        std::memcpy(dst, pattern.bytes.data() + offset, run);
+        dst += run;
+        len -= run;
+        offset = 0;
+    }
+}
+
+void and_pattern(uint8_t* dst, size_t len, const SievePattern& pattern, uint64_t first_byte) {
+    const size_t period = pattern.bytes.size();
+    size_t offset = first_byte % period;
+    while (len > 0) {
+        size_t run = std::min(len, period - offset);
+        and_bytes(dst, pattern.bytes.data() + offset, run);
+        dst += run;
+        len -= run;
+        offset = 0;
+    }
+}
+
+uint64_t isqrt(uint64_t n) {
+    uint64_t r = static_cast<uint64_t>(std::sqrt(static_cast<double>(n)));
+    while (r > 0 && r * r > n) --r;
+    while ((r + 1) * (r + 1) <= n) ++r;
+    return r;
+}
+
+// Primes in [first, sqrt(upper - 1)], enough to sieve [0, upper).
+std::vector<uint32_t> sieving_primes(uint64_t upper, uint64_t first = FIRST_SIEVING_PRIME) {
+    std::vector<uint32_t> primes;
+    if (upper < 2) return primes;
+
+    const uint64_t limit = isqrt(upper - 1);
+    std::vector<uint8_t> composite(limit + 1, 0);
+    for (uint64_t i = 2; i <= limit; ++i) {
+        if (composite[i]) continue;
+        if (i >= first) primes.push_back(static_cast<uint32_t>(i));
+        for (uint64_t j = i * i; j <= limit; j += i) composite[j] = 1;
+    }
+    return primes;
+}
+
+// Bits of byte `byte` whose integers lie in [lower, upper).
+uint8_t range_mask(uint64_t byte, uint64_t lower, uint64_t upper) {
+    uint8_t mask = 0;
+    for (int j = 0; j < 8; ++j) {
+        uint64_t n = 30 * byte + WHEEL30_RESIDUES[j];
+        if (n >= lower && n < upper) mask |= static_cast<uint8_t>(1u << j);
+    }
+    return mask;
+}
+
+uint64_t count_wheel_exceptions(uint64_t lower, uint64_t upper) {
+    uint64_t count = 0;
+    for (uint64_t p : {2, 3, 5}) {
+        if (p >= lower && p < upper) ++count;
+    }
+    return count;
+}
+
+uint64_t popcount_bytes(const uint8_t* bytes, size_t len) {
+    uint64_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        count += __builtin_popcountll(word);
+    }
+    for (; i < len; ++i) count += __builtin_popcount(bytes[i]);
+    return count;
+}
+
+// Sieves consecutive segments; the per-prime cursors carry over from one
+// segment to the next and are only recomputed after a jump.
+class SegmentWorker {
+    const std::vector<uint32_t>& primes;
+    std::vector<uint64_t> next_byte;
+    uint64_t position = UINT64_MAX;
+
+    void seek(uint64_t first_byte) {
+        const uint64_t n0 = 30 * first_byte;
+        for (size_t i = 0; i < primes.size(); ++i) {
+            const uint64_t p = primes[i];
+            const uint64_t k_min = std::max(p, (n0 + p - 1) / p);
+            for (int j = 0; j < 8; ++j) {
+                uint64_t k = k_min + (WHEEL30_RESIDUES[j] + 30 - k_min % 30) % 30;
+                next_byte[8 * i + j] = p * k / 30;
+            }
+        }
+    }
+
+public:
+    explicit SegmentWorker(const std::vector<uint32_t>& sieving)
+        : primes(sieving), next_byte(8 * sieving.size()) {}
+
+    void sieve(uint64_t first_byte, size_t len, uint8_t* seg) {
+        if (first_byte != position) seek(first_byte);
+
+        copy_pattern(seg, len, pattern_a(), first_byte);
+        and_pattern(seg, len, pattern_b(), first_byte);
+
+        // The patterns also clear the pattern primes themselves: 7..29 are
+        // byte 0 and 31 is bit 0 of byte 1, whichever segment holds them.
+        if (first_byte == 0) seg[0] = 0xFE;
+        if (first_byte <= 1 && first_byte + len > 1) seg[1 - first_byte] |= 0x01;
+
+        const uint64_t end_byte = first_byte + len;
+        const uint64_t end_n = 30 * end_byte;
+        for (size_t i = 0; i < primes.size(); ++i) {
+            const uint64_t p = primes[i];
+            if (p * p >= end_n) break;
+
+            const uint32_t p_mod = static_cast<uint32_t>(p % 30);
+            for (int j = 0; j < 8; ++j) {
+                const int bit = WHEEL30_INDEX[p_mod * WHEEL30_RESIDUES[j] % 30];
+                const uint8_t clear = static_cast<uint8_t>(~(1u << bit));
+                uint64_t b = next_byte[8 * i + j];
+                for (; b < end_byte; b += p) seg[b - first_byte] &= clear;
+                next_byte[8 * i + j] = b;
+            }
+        }
+
+        position = end_byte;
+    }
+};
+
+size_t resolve_threads(size_t requested) {
+    if (requested > 0) return requested;
+    return std::max(1, config::get_thread_count());
+}
+
+// Splits [first_byte, end_byte) into runs of whole segments and hands them
+// to `threads` workers; fn(worker, run_first, run_end) is called per run.
+template<typename Fn>
+void parallel_segments(const std::vector<uint32_t>& primes, uint64_t first_byte, uint64_t end_byte,
+                       size_t threads, Fn fn) {
+    const uint64_t total = end_byte - first_byte;
+    const uint64_t segments = (total + SegmentedSieve::SEGMENT_BYTES - 1) / SegmentedSieve::SEGMENT_BYTES;
+    threads = static_cast<size_t>(std::min<uint64_t>(threads, std::max<uint64_t>(segments, 1)));
+    const uint64_t run_segments = std::max<uint64_t>(1, segments / (threads * 4));
+    const uint64_t run_bytes = run_segments * SegmentedSieve::SEGMENT_BYTES;
+
+    std::atomic<uint64_t> next_run{first_byte};
+    auto work = [&]() {
+        SegmentWorker worker(primes);
+        while (true) {
+            uint64_t run_first = next_run.fetch_add(run_bytes);
+            if (run_first >= end_byte) break;
+            fn(worker, run_first, std::min(end_byte, run_first + run_bytes));
+        }
+    };
+
+    parallel::global_pool().run(threads, [&](size_t) { work(); });
+}
+
+}
+
+namespace {
+
+std::unique_ptr<SpfTable> installed_table;
+std::atomic<const SpfTable*> installed_view{nullptr};
+
+}
+
+SpfTable::SpfTable(uint64_t bound_n, size_t threads) : bound(bound_n), odd_spf((bound_n + 1) / 2, 0) {
+    const std::vector<uint32_t> primes = sieving_primes(bound, 3);
+    const uint64_t entries = odd_spf.size();
+    const uint64_t segments = (entries + SEGMENT_ENTRIES - 1) / SEGMENT_ENTRIES;
+
+    // Entry i is the odd number 2i + 1. Primes are applied in increasing
+    // order and only fill empty slots, so each slot keeps its smallest.
+    std::atomic<uint64_t> next_segment{0};
+    auto work = [&]() {
+        while (true) {
+            const uint64_t segment = next_segment.fetch_add(1);
+            if (segment >= segments) break;
+            const uint64_t first = segment * SEGMENT_ENTRIES;
+            const uint64_t last = std::min(entries, first + SEGMENT_ENTRIES);
+            uint32_t* slots = odd_spf.data();
+            for (uint32_t p : primes) {
+                const uint64_t square_index = static_cast<uint64_t>(p) * p / 2;
+                if (square_index >= last) break;
+                uint64_t i = square_index;
+                if (i < first) i += (first - i + p - 1) / p * p;
+                for (; i < last; i += p) {
+                    if (slots[i] == 0) slots[i] = p;
+                }
+            }
+        }
+    };
+
+    threads = static_cast<size_t>(std::min<uint64_t>(resolve_threads(threads), std::max<uint64_t>(segments, 1)));
+    parallel::global_pool().run(threads, [&](size_t) { work(); });
+}
+
+uint64_t SpfTable::smallest_factor(uint64_t n) const {
+    if (n % 2 == 0) return 2;
+    const uint32_t p = odd_spf[n / 2];
+    return p ? p : n;
+}
+
+size_t SpfTable::factor(uint64_t n, uint64_t* primes, int* exponents) const {
+    size_t count = 0;
+    if (n % 2 == 0) {
+        const int twos = __builtin_ctzll(n);
+        n >>= twos;
+        primes[count] = 2;
+        exponents[count++] = twos;
+    }
+    while (n > 1) {
+        const uint32_t spf = odd_spf[n / 2];
+        const uint64_t p = spf ? spf : n;
+        int k = 0;
+        do {
+            n /= p;
+            ++k;
+        } while (n % p == 0);
+        primes[count] = p;
+        exponents[count++] = k;
+    }
+    return count;
+}
+
+void install_spf_table(uint64_t bound, size_t threads) {
+    std::unique_ptr<SpfTable> table;
+    if (bound > 0) table.reset(new SpfTable(bound, threads));
+    installed_view.store(table.get(), std::memory_order_release);
+    installed_table = std::move(table);
+}
+
+const SpfTable* installed_spf_table() {
+    return installed_view.load(std::memory_order_acquire);
+}
+
+PrimeBitset::PrimeBitset(uint64_t lower, uint64_t upper) : low(lower), high(std::max(lower, upper)) {
+    bytes.assign((high + 29) / 30 - low / 30, 0);
+}
+
+bool PrimeBitset::test(uint64_t n) const {
+    if (n < low || n >= high) return false;
+    if (n < 7) return n == 2 || n == 3 || n == 5;
+    const int bit = WHEEL30_INDEX[n % 30];
+    if (bit < 0) return false;
+    return (bytes[n / 30 - low / 30] >> bit) & 1;
+}
+
+uint64_t PrimeBitset::count() const {
+    return popcount_bytes(bytes.data(), bytes.size()) + count_wheel_exceptions(low, high);
+}
+
+SegmentedSieve::SegmentedSieve(size_t threads) : num_threads(resolve_threads(threads)) {}
+
+PrimeBitset SegmentedSieve::sieve_range(uint64_t lower, uint64_t upper) const {
+    PrimeBitset bitset(lower, upper);
+    if (bitset.bytes.empty()) return bitset;
+
+    const uint64_t first_byte = lower / 30;
+    const uint64_t end_byte = first_byte + bitset.bytes.size();
+    const auto primes = sieving_primes(upper);
+
+    parallel_segments(primes, first_byte, end_byte, num_threads,
+        [&](SegmentWorker& worker, uint64_t run_first, uint64_t run_end) {
+            for (uint64_t b = run_first; b < run_end; b += SEGMENT_BYTES) {
+                size_t len = static_cast<size_t>(std::min<uint64_t>(SEGMENT_BYTES, run_end - b));
+                worker.sieve(b, len, bitset.bytes.data() + (b - first_byte));
+            }
+        });
+
+    bitset.bytes.front() &= range_mask(first_byte, lower, upper);
+    bitset.bytes.back() &= range_mask(end_byte - 1, lower, upper);
+    return bitset;
+}
+
+uint64_t SegmentedSieve::count_primes(uint64_t lower, uint64_t upper) const {
+    if (upper <= lower) return 0;
+
+    const uint64_t first_byte = lower / 30;
+    const uint64_t end_byte = (upper + 29) / 30;
+    const auto primes = sieving_primes(upper);
+    std::atomic<uint64_t> total{count_wheel_exceptions(lower, upper)};
+
+    parallel_segments(primes, first_byte, end_byte, num_threads,
+        [&](SegmentWorker& worker, uint64_t run_first, uint64_t run_end) {
+            std::vector<uint8_t> seg(SEGMENT_BYTES);
+            uint64_t local = 0;
+            for (uint64_t b = run_first; b < run_end; b += SEGMENT_BYTES) {
+                size_t len = static_cast<size_t>(std::min<uint64_t>(SEGMENT_BYTES, run_end - b));
+                worker.sieve(b, len, seg.data());
+                if (b == first_byte) seg[0] &= range_mask(b, lower, upper);
+                if (b + len == end_byte) seg[len - 1] &= range_mask(end_byte - 1, lower, upper);
+                local += popcount_bytes(seg.data(), len);
+            }
+            total += local;
+        });
+
+    return total.load();
+}
+
+std::vector<uint64_t> SegmentedSieve::primes(uint64_t lower, uint64_t upper) const {
+    std::vector<uint64_t> result;
+    for_each_prime(lower, upper, [&](uint64_t p) { result.push_back(p); });
+    return result;
+}
+
+void SegmentedSieve::for_each_prime(uint64_t lower, uint64_t upper, const std::function<void(uint64_t)>& fn) const {
+    PrimeIterator it(lower, upper);
+    uint64_t p;
+    while (it.next(p)) fn(p);
+}
+
+struct PrimeIterator::State {
+    uint64_t lower, upper;
+    uint64_t end_byte;
+    std::vector<uint32_t> primes;
+    SegmentWorker worker;
+    std::vector<uint8_t> seg;
+    uint64_t seg_first = 0;
+    size_t seg_len = 0;
+    size_t cursor = 0;
+    uint8_t bits = 0;
+    size_t wheel_exception = 0;
+
+    State(uint64_t lo, uint64_t hi)
+        : lower(lo), upper(hi), end_byte((hi + 29) / 30), primes(sieving_primes(hi)),
+          worker(primes), seg(SegmentedSieve::SEGMENT_BYTES), seg_first(lo / 30) {}
+
+    bool load(uint64_t first_byte) {
+        if (first_byte >= end_byte) return false;
+        seg_first = first_byte;
+        seg_len = static_cast<size_t>(std::min<uint64_t>(SegmentedSieve::SEGMENT_BYTES, end_byte - first_byte));
+        worker.sieve(seg_first, seg_len, seg.data());
+        cursor = 0;
+        bits = seg[0];
+        return true;
+    }
+};
+
+PrimeIterator::PrimeIterator(uint64_t lower, uint64_t upper)
+    : state(std::make_unique<State>(lower, std::max(lower, upper))) {
+    if (state->upper > state->lower && !state->load(state->seg_first)) state->seg_len = 0;
+}
+
+PrimeIterator::~PrimeIterator() = default;
+
+bool PrimeIterator::next(uint64_t& prime) {
+    State& s = *state;
+
+    static constexpr uint64_t WHEEL_EXCEPTIONS[3] = {2, 3, 5};
+    while (s.wheel_exception < 3) {
+        uint64_t p = WHEEL_EXCEPTIONS[s.wheel_exception++];
+        if (p >= s.lower && p < s.upper) {
+            prime = p;
+            return true;
+        }
+    }
+
+    while (s.seg_len > 0) {
+        while (s.bits == 0) {
+            if (++s.cursor == s.seg_len) {
+                if (!s.load(s.seg_first + s.seg_len)) {
+                    s.seg_len = 0;
+                    return false;
+                }
+                continue;
+            }
+            s.bits = s.seg[s.cursor];
+        }
+
+        const int bit = __builtin_ctz(s.bits);
+        s.bits &= static_cast<uint8_t>(s.bits - 1);
+        const uint64_t n = 30 * (s.seg_first + s.cursor) + WHEEL30_RESIDUES[bit];
+        if (n < s.lower) continue;
+        if (n >= s.upper) {
+            s.seg_len = 0;
+            return false;
+        }
+        prime = n;
+        return true;
+    }
+    return false;
+}
+
+void simd_sieve_primes(std::vector<bool>& is_prime, uint64_t limit) {
+    is_prime.assign(limit + 1, false);
+    if (limit < 2) return;
+
+    PrimeIterator it(0, limit + 1);
+    uint64_t p;
+    while (it.next(p)) is_prime[p] = true;
+}
+
+}
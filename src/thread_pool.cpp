@@ -0,0 +1,147 @@
+#include "thread_pool.h"
+#include "config.h"
+#include <fstream>
+#include <string>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace parallel {
+
+namespace {
+
+// CPU ids grouped by NUMA node, node 0 first, from sysfs. Falls back to
+// 0..hardware_concurrency-1 when the topology is not exposed.
+std::vector<int> cpus_by_node() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    for (int node = 0;; ++node) {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!in) break;
+        std::string list;
+        std::getline(in, list);
+        // Comma-separated ids and inclusive ranges, e.g. "0-3,8-11".
+        for (size_t pos = 0; pos < list.size();) {
+            size_t comma = list.find(',', pos);
+            if (comma == std::string::npos) comma = list.size();
+            const std::string item = list.substr(pos, comma - pos);
+            const size_t dash = item.find('-');
+            if (!item.empty()) {
+                const int first = std::stoi(item.substr(0, dash));
+                const int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+            }
+            pos = comma + 1;
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        for (int cpu = 0; cpu < std::max(1, config::get_thread_count()); ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+void pin_current_thread(size_t index) {
+#ifdef __linux__
+    static const std::vector<int> cpus = cpus_by_node();
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[index % cpus.size()], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)index;
+#endif
+}
+
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    work_cv.notify_all();
+    for (auto& helper : helpers) helper.join();
+}
+
+void ThreadPool::set_pinning(bool enabled) {
+    std::lock_guard<std::mutex> lock(mtx);
+    pin = enabled;
+}
+
+size_t ThreadPool::helper_count() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return helpers.size();
+}
+
+void ThreadPool::helper_loop(size_t index) {
+    bool pinned = false;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        if (pin && !pinned) {
+            // Helper 0 shares the first CPU with the caller's slot 0, so
+            // helpers start one CPU further on.
+            pin_current_thread(index + 1);
+            pinned = true;
+        }
+        work_cv.wait(lock, [&] { return stopping || !pending.empty(); });
+        if (stopping) return;
+
+        Job* job = pending.front();
+        const size_t slot = job->next_slot++;
+        if (job->next_slot == job->slots) pending.pop_front();
+        --idle;
+        --unclaimed;
+        lock.unlock();
+
+        (*job->fn)(slot);
+        {
+            std::lock_guard<std::mutex> job_lock(job->mtx);
+            if (--job->remaining == 0) job->done.notify_one();
+        }
+
+        lock.lock();
+        ++idle;
+    }
+}
+
+void ThreadPool::run(size_t workers, const std::function<void(size_t)>& fn) {
+    if (workers <= 1) {
+        fn(0);
+        return;
+    }
+
+    Job job;
+    job.fn = &fn;
+    job.next_slot = 1;
+    job.slots = workers;
+    job.remaining = workers - 1;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        pending.push_back(&job);
+        unclaimed += workers - 1;
+        while (idle < unclaimed) {
+            helpers.emplace_back(&ThreadPool::helper_loop, this, helpers.size());
+            ++idle;
+        }
+    }
+    work_cv.notify_all();
+
+    fn(0);
+
+    std::unique_lock<std::mutex> job_lock(job.mtx);
+    job.done.wait(job_lock, [&] { return job.remaining == 0; });
+}
+
+ThreadPool& global_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+size_t resolve_workers(size_t requested) {
+    if (requested > 0) return requested;
+    return std::max(1, config::get_thread_count());
+}
+
+}
@@ -1,4 +1,5 @@
 #include "ultra_precision.h"
+#include "thread_pool.h"
 #include <cmath>
 #include <chrono>
 #include <fstream>
@@ -82,39 +83,49 @@ ComparisonResult EulerMethodComparison::batch_comparison(
     if (run_cordic) method_names.push_back("CORDIC");
     if (run_arbitrary) method_names.push_back("Arbitrary Precision");
     
-    for (const auto& name : method_names) {
-        final_result.error_distribution[name] = std::vector<long double>();
-        final_result.error_distribution[name].reserve(num_samples);
-    }
-    
-    std::vector<MethodResult> accumulated_results(method_names.size());
-    for (size_t i = 0; i < accumulated_results.size(); i++) {
-        accumulated_results[i].method_name = method_names[i];
-        accumulated_results[i].absolute_error = 0;
-        accumulated_results[i].relative_error = 0;
-        accumulated_results[i].computation_time_ns = 0;
-    }
-    
-    for (size_t i = 0; i < num_samples; i++) {
-        long double theta = static_cast<long double>(i) * 2.0L * M_PI / num_samples;
-        auto single_result = compare_all_methods(theta, run_std, run_taylor, run_cordic, run_arbitrary);
-        
-        for (size_t j = 0; j < single_result.methods.size(); j++) {
-            const auto& method_result = single_result.methods[j];
-            accumulated_results[j].absolute_error += method_result.absolute_error;
-            accumulated_results[j].relative_error += method_result.relative_error;
-            accumulated_results[j].computation_time_ns += method_result.computation_time_ns;
-            
-            final_result.error_distribution[method_result.method_name].push_back(
-                method_result.absolute_error
-            );
+    // Samples run on the thread pool in fixed blocks. Each block keeps its
+    // own sums and streaming statistics, and blocks are merged in order, so
+    // nothing is stored per sample and the result does not depend on the
+    // thread count.
+    struct Totals {
+        std::vector<long double> absolute, relative;
+        std::vector<double> time_ns;
+        std::vector<complex_analysis::StreamingErrorStats> stats;
+    };
+    const size_t methods = method_names.size();
+    const Totals empty{std::vector<long double>(methods, 0), std::vector<long double>(methods, 0),
+                       std::vector<double>(methods, 0), std::vector<complex_analysis::StreamingErrorStats>(methods)};
+    const Totals totals = parallel::parallel_reduce(0, num_samples, 256, empty, [&](uint64_t first, uint64_t last) {
+        Totals t = empty;
+        for (uint64_t i = first; i < last; i++) {
+            long double theta = static_cast<long double>(i) * 2.0L * M_PI / num_samples;
+            auto single_result = compare_all_methods(theta, run_std, run_taylor, run_cordic, run_arbitrary);
+            for (size_t j = 0; j < single_result.methods.size(); j++) {
+                const auto& method_result = single_result.methods[j];
+                t.absolute[j] += method_result.absolute_error;
+                t.relative[j] += method_result.relative_error;
+                t.time_ns[j] += method_result.computation_time_ns;
+                t.stats[j].add(method_result.absolute_error);
+            }
         }
-    }
+        return t;
+    }, [methods](Totals a, const Totals& b) {
+        for (size_t j = 0; j < methods; j++) {
+            a.absolute[j] += b.absolute[j];
+            a.relative[j] += b.relative[j];
+            a.time_ns[j] += b.time_ns[j];
+            a.stats[j].merge(b.stats[j]);
+        }
+        return a;
+    });
     
-    for (auto& result : accumulated_results) {
-        result.absolute_error /= num_samples;
-        result.relative_error /= num_samples;
-        result.computation_time_ns /= num_samples;
+    std::vector<MethodResult> accumulated_results(methods);
+    for (size_t j = 0; j < methods; j++) {
+        accumulated_results[j].method_name = method_names[j];
+        accumulated_results[j].absolute_error = totals.absolute[j] / num_samples;
+        accumulated_results[j].relative_error = totals.relative[j] / num_samples;
+        accumulated_results[j].computation_time_ns = totals.time_ns[j] / num_samples;
+        final_result.error_stats[method_names[j]] = totals.stats[j];
     }
     
     final_result.methods = accumulated_results;
@@ -201,25 +212,14 @@ void EulerMethodComparison::save_error_histogram(const ComparisonResult& result,
     file << "Method,Mean_Abs_Error,Std_Dev_Error,Min_Error,Max_Error,Mean_Time_ns\n";
     
     for (const auto& method : result.methods) {
-        if (result.error_distribution.find(method.method_name) != result.error_distribution.end()) {
-            const auto& errors = result.error_distribution.at(method.method_name);
-            
-            long double mean_error = std::accumulate(errors.begin(), errors.end(), 0.0L) / errors.size();
-            long double variance = 0;
-            for (auto err : errors) {
-                variance += (err - mean_error) * (err - mean_error);
-            }
-            variance /= errors.size();
-            long double std_dev = std::sqrt(variance);
-            
-            long double min_error = *std::min_element(errors.begin(), errors.end());
-            long double max_error = *std::max_element(errors.begin(), errors.end());
-            
+        auto it = result.error_stats.find(method.method_name);
+        if (it != result.error_stats.end()) {
+            const auto& stats = it->second;
             file << method.method_name << "," 
-                 << mean_error << "," 
-                 << std_dev << ","
-                 << min_error << ","
-                 << max_error << ","
+                 << stats.mean() << "," 
+                 << stats.std_deviation() << ","
+                 << stats.min() << ","
+                 << stats.max() << ","
                  << method.computation_time_ns << "\n";
         } else {
             file << method.method_name << "," 
@@ -231,27 +231,27 @@ void EulerMethodComparison::save_error_histogram(const ComparisonResult& result,
         }
     }
     
-    if (result.total_samples > 1 && !result.error_distribution.empty()) {
+    // Log-scale histogram: one row per bucket that any method uses, with
+    // the bucket's lower bound and each method's sample count.
+    if (result.total_samples > 1 && !result.error_stats.empty()) {
+        using complex_analysis::StreamingErrorStats;
         file << "\n# Error Distribution Data\n";
-        file << "Sample";
+        file << "Bucket_Lower_Bound";
         for (const auto& method : result.methods) {
             file << "," << method.method_name;
         }
         file << "\n";
         
-        for (size_t i = 0; i < result.total_samples; i++) {
-            file << i;
+        file << std::scientific << std::setprecision(6);
+        for (size_t bucket = 0; bucket < StreamingErrorStats::BUCKETS; bucket++) {
+            uint64_t used = 0;
+            for (const auto& [name, stats] : result.error_stats) used += stats.buckets()[bucket];
+            if (used == 0) continue;
+            
+            file << StreamingErrorStats::bucket_lower_bound(bucket);
             for (const auto& method : result.methods) {
-                if (result.error_distribution.find(method.method_name) != result.error_distribution.end()) {
-                    const auto& errors = result.error_distribution.at(method.method_name);
-                    if (i < errors.size()) {
-                        file << "," << errors[i];
-                    } else {
-                        file << ",0";
-                    }
-                } else {
-                    file << ",0";
-                }
+                auto it = result.error_stats.find(method.method_name);
+                file << "," << (it != result.error_stats.end() ? it->second.buckets()[bucket] : 0);
             }
             file << "\n";
         }
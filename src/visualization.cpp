@@ -454,6 +454,20 @@ void Visualizer3D::renderRiemannSurface(
     const std::function<complex_analysis::Complex(complex_analysis::Complex)>& function,
     double xMin, double xMax, double yMin, double yMax, int resolution) {
     
+    std::vector<complex_analysis::Complex> values(static_cast<size_t>(resolution) * resolution);
+    for (int j = 0; j < resolution; ++j) {
+        for (int i = 0; i < resolution; ++i) {
+            double x = xMin + (xMax - xMin) * i / (resolution - 1.0);
+            double y = yMin + (yMax - yMin) * j / (resolution - 1.0);
+            values[static_cast<size_t>(j) * resolution + i] = function(complex_analysis::Complex(x, y));
+        }
+    }
+    renderComplexGrid(values, xMin, xMax, yMin, yMax, resolution);
+}
+
+void Visualizer3D::renderComplexGrid(const std::vector<complex_analysis::Complex>& values,
+                                     double xMin, double xMax, double yMin, double yMax, int resolution) {
+    
 #ifdef VTK_FOUND
     auto points = vtkSmartPointer<vtkPoints>::New();
     auto triangles = vtkSmartPointer<vtkCellArray>::New();
@@ -468,8 +482,7 @@ void Visualizer3D::renderRiemannSurface(
             double x = xMin + (xMax - xMin) * i / (resolution - 1.0);
             double y = yMin + (yMax - yMin) * j / (resolution - 1.0);
             
-            complex_analysis::Complex z(x, y);
-            complex_analysis::Complex result = function(z);
+            complex_analysis::Complex result = values[static_cast<size_t>(j) * resolution + i];
             
             double magnitude = std::sqrt(result.real() * result.real() + result.imag() * result.imag());
             double phase = std::atan2(result.imag(), result.real());
@@ -531,13 +544,11 @@ void Visualizer3D::renderRiemannSurface(
     textActor->SetPosition(10, 10);
     impl->renderer->AddActor2D(textActor);
 #else
+    // The image spans the grid, so the coordinates are not needed here.
+    (void)xMin; (void)xMax; (void)yMin; (void)yMax;
     for (int i = 0; i < resolution; ++i) {
         for (int j = 0; j < resolution; ++j) {
-            double x = xMin + (xMax - xMin) * i / (double)resolution;
-            double y = yMin + (yMax - yMin) * j / (double)resolution;
-            
-            complex_analysis::Complex z(x, y);
-            complex_analysis::Complex result = function(z);
+            complex_analysis::Complex result = values[static_cast<size_t>(j) * resolution + i];
             
             double magnitude = std::sqrt(result.real() * result.real() + result.imag() * result.imag());
             double phase = std::atan2(result.imag(), result.real());
@@ -794,16 +805,8 @@ void Visualizer3D::renderEulerFormula(double theta, int revolutions, int points)
 void Visualizer3D::renderPrimeDistribution(int maxNumber, const std::string& method) {
     std::cout << "[VISUALIZATION] Rendering prime distribution up to " << maxNumber << std::endl;
     
-    std::vector<bool> isPrime(maxNumber + 1, true);
-    isPrime[0] = isPrime[1] = false;
-    
-    for (int i = 2; i * i <= maxNumber; ++i) {
-        if (isPrime[i]) {
-            for (int j = i * i; j <= maxNumber; j += i) {
-                isPrime[j] = false;
-            }
-        }
-    }
+    std::vector<bool> isPrime;
+    number_theory::simd_sieve_primes(isPrime, static_cast<uint64_t>(std::max(maxNumber, 1)));
     
 #ifdef VTK_FOUND
     auto points = vtkSmartPointer<vtkPoints>::New();
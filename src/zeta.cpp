@@ -0,0 +1,333 @@
+#include "zeta.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace complex_analysis {
+
+namespace {
+
+using ComplexD = std::complex<double>;
+
+constexpr Real PI_L = 3.141592653589793238462643383279502884L;
+constexpr Real LOG_2 = 0.693147180559945309417232121458176568L;
+constexpr Real LOG_PI = 1.144729885849400174143427351353058712L;
+constexpr Real HALF_LOG_2PI = 0.918938533204672741780329736405617640L;
+
+// B_2k / (2k)! for k = 1..30, the Euler-Maclaurin correction weights.
+constexpr double BERNOULLI_WEIGHTS[] = {
+    8.33333333333333287e-02, -1.38888888888888894e-03, 3.30687830687830710e-05,
+    -8.26719576719576754e-07, 2.08767569878681002e-08, -5.28419013868749322e-10,
+    1.33825365306846789e-11, -3.38968029632258272e-13, 8.58606205627784517e-15,
+    -2.17486869855806192e-16, 5.50900282836022953e-18, -1.39544646858125223e-19,
+    3.53470703962946728e-21, -8.95351742703754628e-23, 2.26795245233768293e-24,
+    -5.74479066887220246e-26, 1.45517247561486496e-27, -3.68599494066531029e-29,
+    9.33673425709504507e-31, -2.36502241570062995e-32, 5.99067176248213414e-34,
+    -1.51745488446829032e-35, 3.84375812545418860e-37, -9.73635307264669126e-39,
+    2.46624704420068111e-40, -6.24707674182074342e-42, 1.58240302446449140e-43,
+    -4.00827368594893575e-45, 1.01530758555695573e-46, -2.57180415824187168e-48,
+};
+constexpr size_t BERNOULLI_TERMS = sizeof(BERNOULLI_WEIGHTS) / sizeof(BERNOULLI_WEIGHTS[0]);
+
+// Power sums along a line are recomputed from exact powers every RESEED
+// points, which bounds the drift of the n^-step recurrence.
+constexpr size_t RESEED = 32;
+
+// Re s < 0 goes through the functional equation except this close to the
+// origin, where zeta(1 - s) sits next to the pole and 1 - s formed in double
+// costs about eps / |s| relative; Euler-Maclaurin stays at a few ulps there.
+constexpr double REFLECTION_MIN_ABS = 0.01;
+
+// Riemann-Siegel corrections C0..C4 as polynomials in z^2 with z = 2p - 1
+// (Gabcke's expansions); C1 and C3 are odd and carry one more factor z.
+// Generated offline from the derivatives of
+// Psi(p) = cos(2 pi (p^2 - p - 1/16)) / cos(2 pi p).
+constexpr double RS_C0[] = {
+    3.82683432365089782e-01, 4.37240468077520428e-01, 1.32376575480343511e-01,
+    -1.36050260476741885e-02, -1.35676219701035810e-02, -1.62372532314446530e-03,
+    2.97053537333796900e-04, 7.94330087952147023e-05, 4.65561246145045036e-07,
+    -1.43272516309551056e-06, -1.03548471123129457e-07, 1.23579270838617381e-08,
+    1.78810838579549058e-09, -3.39141438992703622e-11, -1.63266339025659067e-11,
+    -3.78510931854122053e-13, 9.32742325920172496e-14, 5.22184301597813695e-15,
+    -3.35067307274426389e-16, -3.41242652281172650e-17,
+};
+constexpr double RS_C1[] = {
+    -2.68251026283753483e-02, 1.37847734263518533e-02, 3.84912504822350829e-02,
+    9.87106629906207671e-03, -3.31075976085840442e-03, -1.46478085779541516e-03,
+    -1.32079406248769630e-05, 5.92274870184714163e-05, 5.98024258537344893e-06,
+    -9.64132245616982593e-07, -1.83347337227144126e-07, 4.46708756271783344e-09,
+    2.70963508217727437e-09, 7.78528865431585139e-11, -2.34376260108936890e-11,
+    -1.58301727899875213e-12, 1.21199415737237912e-13, 1.45837811611083057e-14,
+    -2.87863052581319184e-16, -8.66286290212372399e-17,
+};
+constexpr double RS_C2[] = {
+    5.18854283029316840e-03, 3.09465838806347439e-04, -1.13359410782293731e-02,
+    2.23304574195814457e-03, 5.19663740886232989e-03, 3.43991440762083387e-04,
+    -5.91064842747058314e-04, -1.02299725479358572e-04, 2.08883922169927543e-05,
+    5.92766549309653559e-06, -1.64238383624362760e-07, -1.51611997009406841e-07,
+    -5.90780369820666762e-09, 2.09115148594781876e-09, 1.78156495832923503e-10,
+    -1.61640724553538320e-11, -2.38069624966676173e-12, 5.39826529554259474e-14,
+    1.97501421969695158e-14, 2.33328687328826331e-16, -1.11875176100480794e-16,
+    -4.16400948888376688e-18,
+};
+constexpr double RS_C3[] = {
+    -1.33971609071945681e-03, 3.74421513637939385e-03, -1.33031789193214676e-03,
+    -2.26546607654717859e-03, 9.54849999850673086e-04, 6.01003845896360355e-04,
+    -1.01288582867766215e-04, -6.86573344929982581e-05, 5.98536679153859864e-07,
+    3.33165985123994702e-06, 2.19192891024350819e-07, -7.89088424568149448e-08,
+    -9.41468508129526174e-09, 9.57011621088347967e-10, 1.87631374534706616e-10,
+    -4.43783767932339949e-12, -2.24267385056173518e-12, -3.62768686573524345e-14,
+    1.76398095508215819e-14, 7.96076524678677769e-16, -9.41965149058969119e-17,
+    -7.13310385456965777e-18,
+};
+constexpr double RS_C4[] = {
+    4.64833893617633829e-04, -1.00566073653404709e-03, 2.40448565737257943e-04,
+    1.02830861497023220e-03, -7.65786107175564393e-04, -2.03652868030848176e-04,
+    2.32122904910687288e-04, 3.26021442438651946e-05, -2.55790625179495238e-05,
+    -4.10746443891574513e-06, 1.17811136403712940e-06, 2.44565614224845793e-07,
+    -2.39158247673443232e-08, -7.50521420703575559e-09, 1.33122794162584287e-10,
+    1.34406267542256210e-10, 3.51377004243048588e-12, -1.51915445337039202e-12,
+    -8.91541768144708736e-14, 1.11958911652285357e-14, 1.05160133299148157e-15,
+    -5.17865527364668349e-17, -8.06587486191656634e-18,
+};
+
+// B_2k / (2k (2k - 1)) for k = 1..8, the Stirling series for log Gamma.
+constexpr double STIRLING[] = {
+    1.0 / 12, -1.0 / 360, 1.0 / 1260, -1.0 / 1680,
+    1.0 / 1188, -691.0 / 360360, 1.0 / 156, -3617.0 / 122400,
+};
+
+template<size_t N>
+double horner(const double (&coefficients)[N], double x) {
+    double result = 0.0;
+    for (size_t i = N; i-- > 0;) result = result * x + coefficients[i];
+    return result;
+}
+
+// n^-s from ln n. The phase t ln n is formed and reduced mod 2 pi in long
+// double, since in double its rounding error grows with t.
+ComplexD power_neg(Real log_n, ComplexD s) {
+    const double magnitude = std::exp(-s.real() * static_cast<double>(log_n));
+    const Real phase = -static_cast<Real>(s.imag()) * log_n;
+    const double reduced = static_cast<double>(phase - 2 * PI_L * std::nearbyint(phase / (2 * PI_L)));
+    return ComplexD(magnitude * std::cos(reduced), magnitude * std::sin(reduced));
+}
+
+// N for Euler-Maclaurin at |s| up to `reach`: the correction terms then
+// shrink at least as fast as (|s| + 60) / (2 pi N) squared, so the 30
+// weights reach double precision.
+size_t euler_maclaurin_terms(double reach) {
+    return std::max<size_t>(18, static_cast<size_t>(std::ceil(0.3 * (reach + 60.0))));
+}
+
+// (N^(1-s) / (s-1) + N^-s / 2 + sum_k B_2k / (2k)! s (s+1) ... (s+2k-2)
+// N^(-s-2k+1)) / N^-s.
+ComplexD euler_maclaurin_tail(ComplexD s, size_t n_terms) {
+    const double n = static_cast<double>(n_terms), inv_n2 = 1.0 / (n * n);
+    ComplexD series = n / (s - 1.0) + 0.5;
+    ComplexD rising = s / n;
+    for (size_t k = 0; k < BERNOULLI_TERMS; ++k) {
+        const ComplexD term = BERNOULLI_WEIGHTS[k] * rising;
+        series += term;
+        if (std::norm(term) <= 1e-34 * std::norm(series)) break;
+        rising *= (s + static_cast<double>(2 * k + 1)) * (s + static_cast<double>(2 * k + 2)) * inv_n2;
+    }
+    return series;
+}
+
+// zeta(s0 + j step) for j < count with one N for the whole run. The terms
+// n^-s for n <= N are kept in split arrays and advanced by n^-step per
+// point; n < N feed the sum and n = N the tail.
+void euler_maclaurin_line(ComplexD s0, ComplexD step, size_t count, ComplexD* out) {
+    const double reach = std::max(std::abs(s0), std::abs(s0 + static_cast<double>(count - 1) * step));
+    const size_t n_terms = euler_maclaurin_terms(reach);
+
+    // Index i holds n = i + 2; n = 1 contributes 1.
+    const size_t m = n_terms - 1, summed = m - 1;
+    std::vector<Real> log_n(m);
+    std::vector<double> p_re(m), p_im(m), r_re(m), r_im(m);
+    for (size_t i = 0; i < m; ++i) {
+        log_n[i] = std::log(static_cast<Real>(i + 2));
+        if (count == 1) continue;
+        const ComplexD ratio = power_neg(log_n[i], step);
+        r_re[i] = ratio.real();
+        r_im[i] = ratio.imag();
+    }
+
+    for (size_t j = 0; j < count; ++j) {
+        const ComplexD s = s0 + static_cast<double>(j) * step;
+        if (j % RESEED == 0) {
+            for (size_t i = 0; i < m; ++i) {
+                const ComplexD p = power_neg(log_n[i], s);
+                p_re[i] = p.real();
+                p_im[i] = p.imag();
+            }
+        }
+        double sum_re = 1.0, sum_im = 0.0;
+        for (size_t i = 0; i < summed; ++i) {
+            sum_re += p_re[i];
+            sum_im += p_im[i];
+        }
+        out[j] = ComplexD(sum_re, sum_im) + ComplexD(p_re[summed], p_im[summed]) * euler_maclaurin_tail(s, n_terms);
+        if (j + 1 == count || (j + 1) % RESEED == 0) continue;
+        for (size_t i = 0; i < m; ++i) {
+            const double re = p_re[i] * r_re[i] - p_im[i] * r_im[i];
+            p_im[i] = p_re[i] * r_im[i] + p_im[i] * r_re[i];
+            p_re[i] = re;
+        }
+    }
+}
+
+// e^(re + i im) for long double re and im, with im reduced mod 2 pi and re
+// split into k ln 2 + r before going to double.
+ComplexD exp_long(Real re, Real im) {
+    const Real k = std::nearbyint(re / LOG_2);
+    const double magnitude = std::ldexp(std::exp(static_cast<double>(re - k * LOG_2)), static_cast<int>(k));
+    const double phase = static_cast<double>(im - 2 * PI_L * std::nearbyint(im / (2 * PI_L)));
+    return ComplexD(magnitude * std::cos(phase), magnitude * std::sin(phase));
+}
+
+// chi(s) = 2^s pi^(s-1) sin(pi s / 2) Gamma(1 - s), so zeta(s) = chi(s)
+// zeta(1 - s). Gamma(1 - s) comes from Stirling's series once the
+// recurrence has moved z = 1 - s out to |z| >= 15. The exponent has terms
+// of size |s| log |s| that mostly cancel, so those are summed in long
+// double; the small series and sin(pi s / 2) stay in double.
+ComplexD chi(ComplexD s) {
+    ComplexD z = 1.0 - s, shifted = 1.0;
+    while (std::norm(z) < 225) {
+        shifted *= z;
+        z += 1.0;
+    }
+    const ComplexD inv = 1.0 / z, inv2 = inv * inv;
+    ComplexD series = 0.0;
+    for (size_t k = sizeof(STIRLING) / sizeof(STIRLING[0]); k-- > 0;) series = series * inv2 + STIRLING[k];
+    series *= inv;
+
+    // (z - 1/2) log z - z + log(2 pi) / 2 + s log 2 + (s - 1) log pi.
+    const Real x = z.real(), y = z.imag(), sigma = s.real(), t = s.imag();
+    const Real log_abs = 0.5L * std::log(x * x + y * y), arg = std::atan2(y, x);
+    Real re = (x - 0.5L) * log_abs - y * arg - x + HALF_LOG_2PI + sigma * LOG_2 + (sigma - 1) * LOG_PI + series.real();
+    Real im = (x - 0.5L) * arg + y * log_abs - y + t * (LOG_2 + LOG_PI) + series.imag();
+
+    // sin(a + i b) for |b| >= 20 is e^|b| / 2 at phase sign(b) (pi/2 - a),
+    // to a relative e^-40; it joins the exponent instead of overflowing.
+    const Real a_half = PI_L / 2 * sigma, b_half = PI_L / 2 * t;
+    if (std::fabs(b_half) < 20) {
+        const ComplexD sine = std::sin(ComplexD(static_cast<double>(a_half), static_cast<double>(b_half)));
+        return exp_long(re, im) * sine / shifted;
+    }
+    re += std::fabs(b_half) - LOG_2;
+    im += (b_half > 0 ? 1 : -1) * (PI_L / 2 - a_half);
+    return exp_long(re, im) / shifted;
+}
+
+bool is_trivial_zero(ComplexD s) {
+    return s.imag() == 0 && s.real() < 0 && std::fmod(s.real(), 2.0) == 0;
+}
+
+ComplexD riemann_siegel_zeta(double t) {
+    const Real z = riemann_siegel_z(std::fabs(t));
+    const Real theta = riemann_siegel_theta(std::fabs(t));
+    const ComplexD value(static_cast<double>(z * std::cos(theta)), static_cast<double>(-z * std::sin(theta)));
+    return t < 0 ? std::conj(value) : value;
+}
+
+enum class ZetaMethod { EULER_MACLAURIN, REFLECTION, RIEMANN_SIEGEL, POLE };
+
+ZetaMethod method_for(ComplexD s) {
+    if (s == 1.0) return ZetaMethod::POLE;
+    if (s.real() == 0.5 && std::fabs(s.imag()) >= ZETA_RIEMANN_SIEGEL_MIN_T) return ZetaMethod::RIEMANN_SIEGEL;
+    if (s.real() < 0 && std::abs(s) >= REFLECTION_MIN_ABS) return ZetaMethod::REFLECTION;
+    return ZetaMethod::EULER_MACLAURIN;
+}
+
+}
+
+Real riemann_siegel_theta(Real t) {
+    if (t < 0) return -riemann_siegel_theta(-t);
+    const Real inv = 1.0L / t, inv2 = inv * inv;
+    return t / 2 * std::log(t / (2 * PI_L)) - t / 2 - PI_L / 8 +
+           inv * (1.0L / 48 + inv2 * (7.0L / 5760 + inv2 * (31.0L / 80640 + inv2 * (127.0L / 430080))));
+}
+
+Real riemann_siegel_z(Real t) {
+    t = std::fabs(t);
+    const Real a = std::sqrt(t / (2 * PI_L));
+    const uint64_t m = static_cast<uint64_t>(a);
+    const Real theta = riemann_siegel_theta(t);
+
+    Real sum = 0.0L;
+    for (uint64_t n = 1; n <= m; ++n) {
+        const Real nr = static_cast<Real>(n);
+        sum += std::cos(theta - t * std::log(nr)) / std::sqrt(nr);
+    }
+
+    const double z = static_cast<double>(2 * (a - m) - 1), z2 = z * z;
+    const double inv_a = static_cast<double>(1 / a);
+    const double correction =
+        horner(RS_C0, z2) +
+        inv_a * (z * horner(RS_C1, z2) +
+                 inv_a * (horner(RS_C2, z2) + inv_a * (z * horner(RS_C3, z2) + inv_a * horner(RS_C4, z2))));
+    // (-1)^(m-1) (t / 2 pi)^(-1/4) sum_k C_k(p) a^-k
+    const Real remainder = (m % 2 ? 1 : -1) * correction / std::sqrt(a);
+    return 2 * sum + remainder;
+}
+
+Complex riemann_zeta(Complex s) {
+    Complex value;
+    riemann_zeta_line(s, Complex(0.0L, 0.0L), 1, &value);
+    return value;
+}
+
+void riemann_zeta_line(Complex s0, Complex step, size_t count, Complex* out) {
+    const ComplexD base(static_cast<double>(s0.real()), static_cast<double>(s0.imag()));
+    const ComplexD delta(static_cast<double>(step.real()), static_cast<double>(step.imag()));
+    auto point = [&](size_t j) { return base + static_cast<double>(j) * delta; };
+
+    // Consecutive points with the same method form one run; for a line the
+    // runs are contiguous, so Euler-Maclaurin runs share their power sums.
+    std::vector<ComplexD> values;
+    for (size_t first = 0; first < count;) {
+        const ZetaMethod method = method_for(point(first));
+        size_t last = first + 1;
+        while (last < count && method_for(point(last)) == method) ++last;
+        values.resize(last - first);
+
+        switch (method) {
+            case ZetaMethod::EULER_MACLAURIN:
+                euler_maclaurin_line(point(first), delta, last - first, values.data());
+                break;
+            case ZetaMethod::REFLECTION:
+                euler_maclaurin_line(1.0 - point(first), -delta, last - first, values.data());
+                for (size_t j = first; j < last; ++j) {
+                    const ComplexD s = point(j);
+                    values[j - first] = is_trivial_zero(s) ? 0.0 : chi(s) * values[j - first];
+                }
+                break;
+            case ZetaMethod::RIEMANN_SIEGEL:
+                for (size_t j = first; j < last; ++j) values[j - first] = riemann_siegel_zeta(point(j).imag());
+                break;
+            case ZetaMethod::POLE:
+                std::fill(values.begin(), values.end(), ComplexD(std::numeric_limits<double>::infinity(), 0.0));
+                break;
+        }
+        for (size_t j = first; j < last; ++j) out[j] = Complex(values[j - first].real(), values[j - first].imag());
+        first = last;
+    }
+}
+
+void riemann_zeta_grid(Real x_min, Real x_max, Real y_min, Real y_max, size_t width, size_t height,
+                       Complex* out, size_t num_threads) {
+    if (width == 0 || height == 0) return;
+    const Real dx = width > 1 ? (x_max - x_min) / (width - 1) : 0.0L;
+    const Real dy = height > 1 ? (y_max - y_min) / (height - 1) : 0.0L;
+    parallel::parallel_for(0, height, 1, [&](uint64_t first, uint64_t last) {
+        for (uint64_t row = first; row < last; ++row) {
+            riemann_zeta_line(Complex(x_min, y_min + dy * row), Complex(dx, 0.0L), width, out + row * width);
+        }
+    }, num_threads);
+}
+
+}